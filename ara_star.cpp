@@ -0,0 +1,233 @@
+#include "ara_star.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// ʽȨصĶţбļΪ g * WEIGHT_SCALE + w * h
+const long long WEIGHT_SCALE = 1000;
+
+struct AraEntry {
+    long long key;
+    int g;
+    int cell;
+};
+
+struct AraCompare {
+    bool operator()(const AraEntry& a, const AraEntry& b) const {
+        return a.key > b.key || (a.key == b.key && a.g < b.g);
+    }
+};
+
+int Heuristic(const PaddedGrid& grid, int cell, int goal, int connectivity) {
+    int dx = abs((cell & (grid.stride - 1)) - (goal & (grid.stride - 1)));
+    int dy = abs((cell >> grid.shift) - (goal >> grid.shift));
+    if (connectivity == 4) return COST_STRAIGHT * (dx + dy);
+    return COST_STRAIGHT * std::max(dx, dy) + (COST_DIAGONAL - COST_STRAIGHT) * std::min(dx, dy);
+}
+
+} // namespace
+
+void AnytimeWorkspace::Begin(int cellCount) {
+    base.Begin(cellCount);
+    if (static_cast<int>(closedStamp.size()) < cellCount) {
+        closedStamp.resize(cellCount, 0);
+        inconsStamp.resize(cellCount, 0);
+        openStamp.resize(cellCount, 0);
+    }
+    NextRound();
+}
+
+void AnytimeWorkspace::NextRound() {
+    round++;
+    if (round == 0) {
+        std::fill(closedStamp.begin(), closedStamp.end(), 0u);
+        std::fill(inconsStamp.begin(), inconsStamp.end(), 0u);
+        std::fill(openStamp.begin(), openStamp.end(), 0u);
+        round = 1;
+    }
+}
+
+bool RunAnytimeSearch(const PaddedGrid& grid, int startX, int startY, int goalX, int goalY,
+    const AnytimeOptions& options, AnytimeWorkspace& workspace, AnytimeResult& result) {
+    result = AnytimeResult();
+
+    if (startX < 0 || startX >= grid.width || startY < 0 || startY >= grid.height ||
+        goalX < 0 || goalX >= grid.width || goalY < 0 || goalY >= grid.height) {
+        return false;
+    }
+
+    const int start = grid.ToPadded(startX, startY);
+    const int goal = grid.ToPadded(goalX, goalY);
+    if (grid.walls[start] || grid.walls[goal]) return false;
+
+    const auto startTime = std::chrono::steady_clock::now();
+    const int connectivity = options.search.connectivity == 4 ? 4 : 8;
+    const CornerRule rule = options.search.cornerRule;
+    const unsigned char* walls = grid.walls.data();
+
+    int offsets[8];
+    for (int i = 0; i < 8; i++) {
+        offsets[i] = SEARCH_DIRECTIONS[i][1] * grid.stride + SEARCH_DIRECTIONS[i][0];
+    }
+
+    workspace.Begin(grid.CellCount());
+    SearchWorkspace& ws = workspace.base;
+
+    double weight = std::max(1.0, options.initialWeight);
+    const double weightStep = options.weightStep > 0.0 ? options.weightStep : weight;
+    long long w = std::llround(weight * WEIGHT_SCALE);
+
+    std::vector<AraEntry> openList;
+    std::vector<int> incons;
+    AraCompare compare;
+
+    ws.Open(start, 0, -1);
+    openList.push_back({ w * Heuristic(grid, start, goal, connectivity), 0, start });
+    SEARCH_PROFILE_PUSH(ws, startX, startY);
+
+    // беЧԪأgֵδұδر
+    auto isLive = [&](const AraEntry& entry) {
+        return entry.g == ws.G(entry.cell) && workspace.closedStamp[entry.cell] != workspace.round;
+    };
+
+    // Ŵ۵½磺оֲһ½ڵ㣨OPENINCONS g + h Сֵ
+    auto lowerBound = [&]() {
+        long long best = std::numeric_limits<long long>::max();
+        for (size_t i = 0; i < openList.size(); i++) {
+            if (isLive(openList[i])) {
+                best = std::min(best, static_cast<long long>(openList[i].g) + Heuristic(grid, openList[i].cell, goal, connectivity));
+            }
+        }
+        for (size_t i = 0; i < incons.size(); i++) {
+            best = std::min(best, static_cast<long long>(ws.G(incons[i])) + Heuristic(grid, incons[i], goal, connectivity));
+        }
+        return best;
+    };
+
+    auto outOfBudget = [&]() {
+        if (options.maxExpansions > 0 && result.expanded >= options.maxExpansions) return true;
+        if (options.deadlineMicros > 0 && (result.expanded & 63) == 0) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - startTime).count();
+            if (elapsed >= options.deadlineMicros) return true;
+        }
+        return false;
+    };
+
+    double bestBound = std::numeric_limits<double>::infinity();
+
+    while (true) {
+        // ImprovePathֱյfֵڿбеС
+        while (!openList.empty()) {
+            if (ws.IsVisited(goal) && static_cast<long long>(ws.G(goal)) * WEIGHT_SCALE <= openList.front().key) break;
+            if (outOfBudget()) {
+                result.interrupted = true;
+                break;
+            }
+
+            std::pop_heap(openList.begin(), openList.end(), compare);
+            AraEntry entry = openList.back();
+            openList.pop_back();
+            if (!isLive(entry)) continue;
+
+            const int current = entry.cell;
+            workspace.closedStamp[current] = workspace.round;
+            result.expanded++;
+            SEARCH_PROFILE_EXPAND(ws, grid.PaddedX(current), grid.PaddedY(current));
+
+            for (int i = 0; i < connectivity; i++) {
+                const int next = current + offsets[i];
+                if (walls[next]) continue;
+                if (i >= 4) {
+                    const bool wallX = walls[current + SEARCH_DIRECTIONS[i][0]] != 0;
+                    const bool wallY = walls[current + SEARCH_DIRECTIONS[i][1] * grid.stride] != 0;
+                    if (rule == CORNER_BLOCK_BOTH ? (wallX && wallY) : (wallX || wallY)) continue;
+                }
+
+                const int newG = entry.g + MoveCost(i);
+                if (newG >= ws.G(next)) continue;
+                ws.Open(next, newG, current);
+
+                if (workspace.closedStamp[next] == workspace.round) {
+                    // ѹرյĽڵINCONSһٴ
+                    if (workspace.inconsStamp[next] != workspace.round) {
+                        workspace.inconsStamp[next] = workspace.round;
+                        incons.push_back(next);
+                    }
+                }
+                else {
+                    openList.push_back({ static_cast<long long>(newG) * WEIGHT_SCALE + w * Heuristic(grid, next, goal, connectivity), newG, next });
+                    std::push_heap(openList.begin(), openList.end(), compare);
+                    SEARCH_PROFILE_PUSH(ws, grid.PaddedX(next), grid.PaddedY(next));
+                }
+            }
+        }
+
+        if (!ws.IsVisited(goal)) {
+            // бľδյ㣺·
+            if (!result.interrupted) result.optimal = true;
+            return false;
+        }
+
+        long long lb = lowerBound();
+        double ratio = lb == std::numeric_limits<long long>::max() || lb <= 0 ? 1.0
+            : static_cast<double>(ws.G(goal)) / static_cast<double>(lb);
+        bestBound = std::min(bestBound, std::max(1.0, ratio));
+        if (result.interrupted) break;
+
+        // һɣ·۲ weight Ŵ
+        bestBound = std::min(bestBound, weight);
+        result.iterations++;
+        if (bestBound <= 1.0) {
+            result.optimal = true;
+            break;
+        }
+
+        // ȨأINCONS뿪бȨؽչرб
+        weight = std::max(1.0, weight - weightStep);
+        w = std::llround(weight * WEIGHT_SCALE);
+
+        std::vector<AraEntry> live;
+        live.reserve(openList.size() + incons.size());
+        for (size_t i = 0; i < openList.size(); i++) {
+            if (isLive(openList[i])) live.push_back(openList[i]);
+        }
+        for (size_t i = 0; i < incons.size(); i++) {
+            live.push_back({ 0, ws.G(incons[i]), incons[i] });
+        }
+        incons.clear();
+        workspace.NextRound();
+
+        openList.clear();
+        for (size_t i = 0; i < live.size(); i++) {
+            const int cell = live[i].cell;
+            if (workspace.openStamp[cell] == workspace.round) continue;
+            workspace.openStamp[cell] = workspace.round;
+            const int g = ws.G(cell);
+            openList.push_back({ static_cast<long long>(g) * WEIGHT_SCALE + w * Heuristic(grid, cell, goal, connectivity), g, cell });
+        }
+        std::make_heap(openList.begin(), openList.end(), compare);
+    }
+
+    // ظڵݵǰ·ʵʴ
+    for (int p = goal; p != -1; p = ws.Parent(p)) {
+        result.path.push_back(grid.ToMapIndex(p));
+        if (p == start) break;
+    }
+    std::reverse(result.path.begin(), result.path.end());
+
+    result.cost = 0;
+    for (size_t i = 1; i < result.path.size(); i++) {
+        bool diagonal = result.path[i] % grid.width != result.path[i - 1] % grid.width &&
+            result.path[i] / grid.width != result.path[i - 1] / grid.width;
+        result.cost += diagonal ? COST_DIAGONAL : COST_STRAIGHT;
+    }
+
+    result.found = true;
+    result.bound = result.optimal ? 1.0 : bestBound;
+    return true;
+}
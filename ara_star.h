@@ -0,0 +1,39 @@
+#pragma once
+
+#include "search_kernel.h"
+
+#include <vector>
+
+// ʱжϵA*ARA*ýϴʽȨؿٵõ·
+// 𲽽ȨزĽ·ֱֹʱչԤ
+
+struct AnytimeOptions {
+    SearchOptions search;
+    double initialWeight = 3.0;     // ʼʽȨ
+    double weightStep = 0.5;        // ÿֽ͵Ȩ
+    long long deadlineMicros = 0;   // ֹʱ䣨΢룬0ʾޣ
+    size_t maxExpansions = 0;       // չԤ㣨0ʾޣ
+};
+
+struct AnytimeResult : SearchResult {
+    double bound = 0.0;             // Ž磺cost <= bound * Ŵ
+    int iterations = 0;             // ɵĸĽ
+    bool optimal = false;           // Ƿ֤
+    bool interrupted = false;       // ǷֹʱԤж
+};
+
+// ARA*Ŀɸʱ
+struct AnytimeWorkspace {
+    SearchWorkspace base;                 // gֵ븸ڵ㣨ѯ
+    std::vector<unsigned int> closedStamp;   // ѹرգִδ
+    std::vector<unsigned int> inconsStamp;   // INCONSбУִδ
+    std::vector<unsigned int> openStamp;     // ؽбʱȥأִδ
+    unsigned int round = 0;
+
+    void Begin(int cellCount);
+    void NextRound();
+};
+
+// ڴ߿ͼִARA*ؽֹǰҵ·Ž
+bool RunAnytimeSearch(const PaddedGrid& grid, int startX, int startY, int goalX, int goalY,
+    const AnytimeOptions& options, AnytimeWorkspace& workspace, AnytimeResult& result);
@@ -0,0 +1,387 @@
+#include "distance_field.h"
+
+#include <cstdint>
+#include <queue>
+#include <utility>
+#include <functional>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DISTANCE_FIELD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Ǳ任бʾ޾롱һҲ
+const int32_t INFINITE_COST = 1 << 29;
+
+// ϰʱɨ֮ԿɸĽĸӽȶ
+const int CHAMFER_ROUNDS = 2;
+
+int LowestBit(uint64_t value) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    if (_BitScanForward(&index, static_cast<unsigned long>(value))) return static_cast<int>(index);
+    _BitScanForward(&index, static_cast<unsigned long>(value >> 32));
+    return static_cast<int>(index) + 32;
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+// д洢λͼÿwords64λ֣xڵx >> 6ֵĵx & 63λԽΪ0
+struct BitRows {
+    int height = 0;
+    int words = 0;
+    std::vector<uint64_t> bits;
+
+    void Reset(int rowCount, int wordCount) {
+        height = rowCount;
+        words = wordCount;
+        bits.assign(static_cast<size_t>(rowCount) * wordCount, 0);
+    }
+
+    uint64_t Word(int y, int w) const {
+        return (y < 0 || y >= height || w < 0 || w >= words) ? 0 : bits[static_cast<size_t>(y) * words + w];
+    }
+
+    // xƽdx-101֮ĵw֣xȡԭx - dxλ
+    uint64_t Shifted(int y, int w, int dx) const {
+        if (dx > 0) return (Word(y, w) << 1) | (Word(y, w - 1) >> 63);
+        if (dx < 0) return (Word(y, w) >> 1) | (Word(y, w + 1) << 63);
+        return Word(y, w);
+    }
+};
+
+// yеwУһܴ֮Ӳǰĸӣδߡδ룩
+uint64_t ReachWord(const BitRows& frontier, const BitRows& free, int y, int w, const SearchOptions& options) {
+    uint64_t reach = frontier.Shifted(y, w, 1) | frontier.Shifted(y, w, -1) | frontier.Word(y - 1, w) | frontier.Word(y + 1, w);
+    if (options.connectivity != 8) return reach;
+
+    // (x - dx, y - dy)бߵ(x, y)ֱڸΪ(x, y - dy)(x - dx, y)
+    for (int dy = -1; dy <= 1; dy += 2) {
+        for (int dx = -1; dx <= 1; dx += 2) {
+            const uint64_t moves = frontier.Shifted(y - dy, w, dx);
+            if (moves == 0) continue;
+            const uint64_t sideA = free.Word(y - dy, w);
+            const uint64_t sideB = free.Shifted(y, w, dx);
+            reach |= moves & (options.cornerRule == CORNER_BLOCK_ANY ? (sideA & sideB) : (sideA | sideB));
+        }
+    }
+    return reach;
+}
+
+// һȦ߿Ĵ飺߿ϰblockedΪ-1Ϊ0
+struct ChamferGrid {
+    int width = 0;      // ߿
+    int height = 0;
+    std::vector<int32_t> cost;
+    std::vector<int32_t> blocked;
+
+    void Reset(const GridMap& map, int32_t borderCost) {
+        width = map.width + 2;
+        height = map.height + 2;
+        cost.assign(static_cast<size_t>(width) * height, borderCost);
+        blocked.assign(static_cast<size_t>(width) * height, -1);
+    }
+
+    int Index(int x, int y) const { return (y + 1) * width + (x + 1); }
+};
+
+#ifdef DISTANCE_FIELD_SSE2
+inline __m128i Select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+inline __m128i Min32(__m128i a, __m128i b) {
+    return Select(_mm_cmplt_epi32(a, b), a, b);
+}
+#endif
+
+// һУʱΪһУʱΪһУھӸrow[first, last]ǷиӱС
+// бھ(c  1, other)ֱڸΪ(c  1, row)(c, other)
+bool RelaxFromRow(int32_t* row, const int32_t* other, const int32_t* blockedRow, const int32_t* blockedOther,
+    int first, int last, const SearchOptions& options) {
+    const bool diagonal = options.connectivity == 8;
+    const bool blockAny = options.cornerRule == CORNER_BLOCK_ANY;
+    bool changed = false;
+    int c = first;
+
+#ifdef DISTANCE_FIELD_SSE2
+    const __m128i straight = _mm_set1_epi32(COST_STRAIGHT);
+    const __m128i diagonalCost = _mm_set1_epi32(COST_DIAGONAL);
+    const __m128i infinite = _mm_set1_epi32(INFINITE_COST);
+    __m128i anyChange = _mm_setzero_si128();
+
+    for (; c + 3 <= last; c += 4) {
+        const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + c));
+        __m128i best = Min32(current, _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(other + c)), straight));
+
+        if (diagonal) {
+            const __m128i otherSide = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blockedOther + c));
+            for (int dx = -1; dx <= 1; dx += 2) {
+                const __m128i rowSide = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blockedRow + c + dx));
+                const __m128i cut = blockAny ? _mm_or_si128(rowSide, otherSide) : _mm_and_si128(rowSide, otherSide);
+                const __m128i from = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(other + c + dx)), diagonalCost);
+                best = Min32(best, Select(cut, infinite, from));
+            }
+        }
+
+        // ϰ񱣳ԭֵ
+        const __m128i target = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blockedRow + c));
+        best = Select(target, current, best);
+        anyChange = _mm_or_si128(anyChange, _mm_cmplt_epi32(best, current));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + c), best);
+    }
+    changed = _mm_movemask_epi8(anyChange) != 0;
+#endif
+
+    for (; c <= last; c++) {
+        if (blockedRow[c]) continue;
+        int32_t best = other[c] + COST_STRAIGHT;
+        if (diagonal) {
+            for (int dx = -1; dx <= 1; dx += 2) {
+                const bool cut = blockAny ? (blockedRow[c + dx] || blockedOther[c]) : (blockedRow[c + dx] && blockedOther[c]);
+                if (!cut) best = std::min(best, other[c + dx] + COST_DIAGONAL);
+            }
+        }
+        if (best < row[c]) {
+            row[c] = best;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// ͬһstep1ҡ-1ۻ/ھӣһȡԱ߿
+bool SweepRow(int32_t* row, const int32_t* blockedRow, int first, int last, int step) {
+    bool changed = false;
+    const int begin = step > 0 ? first : last;
+    const int end = step > 0 ? last + 1 : first - 1;
+    for (int c = begin; c != end; c += step) {
+        if (blockedRow[c]) continue;
+        const int32_t value = row[c - step] + COST_STRAIGHT;
+        if (value < row[c]) {
+            row[c] = value;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// Ϊһ֣maxRoundsֵ֣ٱ仯ʱǰһǷб仯
+bool RunChamfer(ChamferGrid& grid, const SearchOptions& options, int maxRounds) {
+    const int first = 1, last = grid.width - 2;
+    bool changed = true;
+    for (int round = 0; round < maxRounds && changed; round++) {
+        changed = false;
+        for (int y = 1; y <= grid.height - 2; y++) {
+            int32_t* row = &grid.cost[static_cast<size_t>(y) * grid.width];
+            const int32_t* blockedRow = &grid.blocked[static_cast<size_t>(y) * grid.width];
+            changed |= RelaxFromRow(row, row - grid.width, blockedRow, blockedRow - grid.width, first, last, options);
+            changed |= SweepRow(row, blockedRow, first, last, 1);
+        }
+        for (int y = grid.height - 2; y >= 1; y--) {
+            int32_t* row = &grid.cost[static_cast<size_t>(y) * grid.width];
+            const int32_t* blockedRow = &grid.blocked[static_cast<size_t>(y) * grid.width];
+            changed |= RelaxFromRow(row, row + grid.width, blockedRow, blockedRow + grid.width, first, last, options);
+            changed |= SweepRow(row, blockedRow, first, last, -1);
+        }
+    }
+    return changed;
+}
+
+// ɨĳ·ĴۣϽ磩ϰҪ۷·Ҫֲܶ
+// ҳܱھӸĽĸӣǿʼ˳ֱûиٸĽĸ
+size_t RepairChamfer(ChamferGrid& grid, const SearchOptions& options) {
+    typedef std::pair<int32_t, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+
+    int offsets[8];
+    for (int d = 0; d < 8; d++) offsets[d] = SEARCH_DIRECTIONS[d][1] * grid.width + SEARCH_DIRECTIONS[d][0];
+
+    // ƶϷֻȡ˺ֱڸͬ
+    auto canMove = [&](int from, int d) {
+        if (grid.blocked[from + offsets[d]]) return false;
+        if (d < 4) return true;
+        const bool wallX = grid.blocked[from + SEARCH_DIRECTIONS[d][0]] != 0;
+        const bool wallY = grid.blocked[from + SEARCH_DIRECTIONS[d][1] * grid.width] != 0;
+        return options.cornerRule == CORNER_BLOCK_BOTH ? !(wallX && wallY) : !(wallX || wallY);
+    };
+
+    for (int y = 1; y <= grid.height - 2; y++) {
+        for (int x = 1; x <= grid.width - 2; x++) {
+            const int cell = y * grid.width + x;
+            if (grid.blocked[cell]) continue;
+            int32_t best = grid.cost[cell];
+            for (int d = 0; d < options.connectivity; d++) {
+                if (canMove(cell, d)) best = std::min(best, grid.cost[cell + offsets[d]] + MoveCost(d));
+            }
+            if (best < grid.cost[cell]) {
+                grid.cost[cell] = best;
+                queue.push(Entry(best, cell));
+            }
+        }
+    }
+
+    size_t repaired = queue.size();
+    while (!queue.empty()) {
+        const Entry top = queue.top();
+        queue.pop();
+        if (top.first != grid.cost[top.second]) continue;
+        for (int d = 0; d < options.connectivity; d++) {
+            if (!canMove(top.second, d)) continue;
+            const int next = top.second + offsets[d];
+            const int32_t value = top.first + MoveCost(d);
+            if (value < grid.cost[next]) {
+                grid.cost[next] = value;
+                queue.push(Entry(value, next));
+                repaired++;
+            }
+        }
+    }
+    return repaired;
+}
+
+} // namespace
+
+void ComputeStepField(const GridMap& map, const std::vector<int>& sources, const SearchOptions& options,
+    std::vector<int>& distances) {
+    distances.assign(map.CellCount(), DISTANCE_UNREACHABLE);
+    if (map.CellCount() == 0) return;
+
+    const int words = (map.width + 63) >> 6;
+    BitRows free, visited, frontier;
+    free.Reset(map.height, words);
+    visited.Reset(map.height, words);
+    frontier.Reset(map.height, words);
+    for (int y = 0; y < map.height; y++) {
+        for (int x = 0; x < map.width; x++) {
+            if (!map.walls[map.Index(x, y)]) free.bits[static_cast<size_t>(y) * words + (x >> 6)] |= 1ull << (x & 63);
+        }
+    }
+
+    // activeΪǰǰ֣candidatesΪ¸ӿ֣еͬһ֣
+    // Լֵ/λвǰʱ/ڵ֣б
+    std::vector<int> active, candidates, nextActive;
+    std::vector<uint64_t> reached(frontier.bits.size(), 0);
+    std::vector<unsigned int> candidateStamp(frontier.bits.size(), 0);
+
+    for (size_t i = 0; i < sources.size(); i++) {
+        const int cell = sources[i];
+        if (cell < 0 || cell >= map.CellCount() || map.walls[cell]) continue;
+        const int x = cell % map.width, y = cell / map.width;
+        const int word = y * words + (x >> 6);
+        if (frontier.bits[word] == 0) active.push_back(word);
+        frontier.bits[word] |= 1ull << (x & 63);
+        visited.bits[word] |= 1ull << (x & 63);
+        distances[cell] = 0;
+    }
+
+    for (unsigned int step = 1; !active.empty(); step++) {
+        candidates.clear();
+        for (size_t i = 0; i < active.size(); i++) {
+            const int y = active[i] / words, w = active[i] % words;
+            const uint64_t bits = frontier.bits[active[i]];
+            const int firstWord = (bits & 1) && w > 0 ? w - 1 : w;
+            const int lastWord = (bits >> 63) && w + 1 < words ? w + 1 : w;
+            for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, map.height - 1); ny++) {
+                for (int nw = firstWord; nw <= lastWord; nw++) {
+                    const int word = ny * words + nw;
+                    if (candidateStamp[word] == step) continue;
+                    candidateStamp[word] = step;
+                    candidates.push_back(word);
+                }
+            }
+        }
+
+        // ȸɲǰ²ǰͳһ滻
+        nextActive.clear();
+        for (size_t i = 0; i < candidates.size(); i++) {
+            const int word = candidates[i];
+            const uint64_t reach = ReachWord(frontier, free, word / words, word % words, options) &
+                free.bits[word] & ~visited.bits[word];
+            if (reach == 0) continue;
+            reached[word] = reach;
+            nextActive.push_back(word);
+        }
+
+        for (size_t i = 0; i < active.size(); i++) frontier.bits[active[i]] = 0;
+        for (size_t i = 0; i < nextActive.size(); i++) {
+            const int word = nextActive[i];
+            uint64_t bits = reached[word];
+            frontier.bits[word] = bits;
+            visited.bits[word] |= bits;
+
+            const int rowStart = (word / words) * map.width + (word % words) * 64;
+            while (bits != 0) {
+                distances[rowStart + LowestBit(bits)] = static_cast<int>(step);
+                bits &= bits - 1;
+            }
+        }
+        active.swap(nextActive);
+    }
+}
+
+size_t ComputeCostField(const GridMap& map, const std::vector<int>& sources, const SearchOptions& options,
+    std::vector<int>& distances) {
+    distances.assign(map.CellCount(), DISTANCE_UNREACHABLE);
+    if (map.CellCount() == 0) return 0;
+
+    ChamferGrid grid;
+    grid.Reset(map, INFINITE_COST);
+    for (int y = 0; y < map.height; y++) {
+        for (int x = 0; x < map.width; x++) {
+            if (!map.walls[map.Index(x, y)]) grid.blocked[grid.Index(x, y)] = 0;
+        }
+    }
+    for (size_t i = 0; i < sources.size(); i++) {
+        const int cell = sources[i];
+        if (cell < 0 || cell >= map.CellCount() || map.walls[cell]) continue;
+        grid.cost[grid.Index(cell % map.width, cell / map.width)] = 0;
+    }
+
+    size_t repaired = 0;
+    if (RunChamfer(grid, options, CHAMFER_ROUNDS)) repaired = RepairChamfer(grid, options);
+
+    for (int y = 0; y < map.height; y++) {
+        for (int x = 0; x < map.width; x++) {
+            const int32_t value = grid.cost[grid.Index(x, y)];
+            if (value < INFINITE_COST) distances[map.Index(x, y)] = value;
+        }
+    }
+    return repaired;
+}
+
+void ComputeWallDistance(const GridMap& map, std::vector<int>& distances) {
+    distances.assign(map.CellCount(), 0);
+    if (map.CellCount() == 0) return;
+
+    // ǽ߿Դ㣬ûϰǽ赲ʱɨǾȷİ˷
+    ChamferGrid grid;
+    grid.Reset(map, 0);
+    std::fill(grid.blocked.begin(), grid.blocked.end(), 0);
+    for (int y = 0; y < map.height; y++) {
+        for (int x = 0; x < map.width; x++) {
+            if (!map.walls[map.Index(x, y)]) grid.cost[grid.Index(x, y)] = INFINITE_COST;
+        }
+    }
+
+    SearchOptions options;
+    RunChamfer(grid, options, 1);
+
+    for (int y = 0; y < map.height; y++) {
+        for (int x = 0; x < map.width; x++) {
+            distances[map.Index(x, y)] = grid.cost[grid.Index(x, y)];
+        }
+    }
+}
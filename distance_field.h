@@ -0,0 +1,29 @@
+#pragma once
+
+#include "grid_map.h"
+
+#include <vector>
+#include <cstddef>
+
+// ŵͼľ볡һиӵһԴ㣨ǽľ룬
+//   ComputeStepField  λۣÿ1ͼд64λλͼÿһλչǰ
+//                     ֻǰּ
+//   ComputeCostField  10/14ۣ鵹Ǿ任ϵ¡µϣ
+//                     һеھӰSSE2ÿ4񣩣ͬе/ھۻ
+//                     ɨֺܱھӸĽĸӣҪ۷ƹǽ·ȶ
+//                     ֱǽ·
+//   ComputeWallDistance  ÿӵǽͼΪǽİ˷룬ɨ輴ɵõ
+// 鰴д洢y * width + xǽͲɴĸΪDISTANCE_UNREACHABLE
+
+const int DISTANCE_UNREACHABLE = -1;
+
+// sourcesΪǽ񱻺
+void ComputeStepField(const GridMap& map, const std::vector<int>& sources, const SearchOptions& options,
+    std::vector<int>& distances);
+
+// ɨ֮ĸͼΪ0
+size_t ComputeCostField(const GridMap& map, const std::vector<int>& sources, const SearchOptions& options,
+    std::vector<int>& distances);
+
+// ǽΪ0
+void ComputeWallDistance(const GridMap& map, std::vector<int>& distances);
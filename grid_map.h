@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+// 湲õĵͼʾƶ򣨲Windows API
+
+// ƶǰ4Ϊֱ߷򣬺4ΪԽ߷˳ӻеAStarSearchһ£
+const int SEARCH_DIRECTIONS[8][2] = { {0,1}, {1,0}, {0,-1}, {-1,0}, {1,1}, {1,-1}, {-1,1}, {-1,-1} };
+
+// ƶ
+const int COST_STRAIGHT = 10;
+const int COST_DIAGONAL = 14;
+
+// Խƶֱǽ
+enum CornerRule {
+    CORNER_BLOCK_BOTH = 0,  // ֱڸǽʱֹӻߵĬϹ
+    CORNER_BLOCK_ANY = 1    // һֱڸǽʱֹнǣ
+};
+
+// ѡ
+struct SearchOptions {
+    int connectivity = 8;                   // 48
+    CornerRule cornerRule = CORNER_BLOCK_BOTH;
+};
+
+// ͼֻǽǽ
+struct GridMap {
+    int width;
+    int height;
+    std::vector<unsigned char> walls;  // 1ʾǽд洢
+
+    GridMap() : width(0), height(0) {}
+    GridMap(int w, int h) : width(w), height(h), walls(static_cast<size_t>(w) * h, 0) {}
+
+    int CellCount() const { return width * height; }
+    int Index(int x, int y) const { return y * width + x; }
+    bool InBounds(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+
+    // ԽΪǽ
+    bool IsWall(int x, int y) const {
+        return !InBounds(x, y) || walls[Index(x, y)] != 0;
+    }
+};
+
+// (x, y)طdirƶһǷϷԽ硢ĿΪǽֱǽ赲
+inline bool CanMove(const GridMap& map, int x, int y, int dir, CornerRule rule = CORNER_BLOCK_BOTH) {
+    int dx = SEARCH_DIRECTIONS[dir][0];
+    int dy = SEARCH_DIRECTIONS[dir][1];
+    if (map.IsWall(x + dx, y + dy)) return false;
+    if (dir < 4) return true;
+
+    bool wallX = map.IsWall(x + dx, y);
+    bool wallY = map.IsWall(x, y + dy);
+    return rule == CORNER_BLOCK_BOTH ? !(wallX && wallY) : !(wallX || wallY);
+}
+
+// ƶ
+inline int MoveCost(int dir) {
+    return dir < 4 ? COST_STRAIGHT : COST_DIAGONAL;
+}
+
+// ˷루Խ14ֱ10Ϊ8Ŀɲһµʽ
+inline int OctileDistance(int x1, int y1, int x2, int y2) {
+    int dx = abs(x1 - x2);
+    int dy = abs(y1 - y2);
+    return COST_STRAIGHT * std::max(dx, dy) + (COST_DIAGONAL - COST_STRAIGHT) * std::min(dx, dy);
+}
+
+// 
+struct SearchResult {
+    bool found = false;
+    int cost = 0;                 // ·ܴ
+    std::vector<int> path;        // ·ϵĵԪy * width + x㵽յ
+    size_t expanded = 0;          // չڵ
+};
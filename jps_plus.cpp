@@ -0,0 +1,303 @@
+#include "jps_plus.h"
+#include "map_file.h"
+
+#include <algorithm>
+
+namespace {
+
+int Sign(int value) {
+    return value > 0 ? 1 : (value < 0 ? -1 : 0);
+}
+
+int DirectionIndex(int dx, int dy) {
+    for (int d = 0; d < 8; d++) {
+        if (SEARCH_DIRECTIONS[d][0] == dx && SEARCH_DIRECTIONS[d][1] == dy) return d;
+    }
+    return -1;
+}
+
+// ֱ߷(x, y)ʱǷǿھӣǽǰǿո
+bool IsStraightJumpPoint(const GridMap& map, int x, int y, int dx, int dy) {
+    for (int side = -1; side <= 1; side += 2) {
+        int px = dy != 0 ? side : 0;
+        int py = dx != 0 ? side : 0;
+        if (map.IsWall(x + px, y + py) && !map.IsWall(x + px + dx, y + py + dy)) return true;
+    }
+    return false;
+}
+
+// ضԽǷ(x, y)ʱǷǿھӣһǽòǰǿո
+bool HasDiagonalForcedNeighbor(const GridMap& map, int x, int y, int dx, int dy) {
+    return (map.IsWall(x - dx, y) && !map.IsWall(x - dx, y + dy)) ||
+        (map.IsWall(x, y - dy) && !map.IsWall(x + dx, y - dy));
+}
+
+} // namespace
+
+// һǷߡǷΪ㣬һֵϼһ
+int JumpTable::Compute(const GridMap& map, int x, int y, int dir) const {
+    if (map.IsWall(x, y) || !CanMove(map, x, y, dir)) return 0;
+
+    const int dx = SEARCH_DIRECTIONS[dir][0];
+    const int dy = SEARCH_DIRECTIONS[dir][1];
+    const int nx = x + dx, ny = y + dy;
+    const int next = map.Index(nx, ny);
+
+    bool jumpPoint;
+    if (dir < 4) {
+        jumpPoint = IsStraightJumpPoint(map, nx, ny, dx, dy);
+    }
+    else {
+        // Խϵĸֱ߷ʱҲ
+        jumpPoint = HasDiagonalForcedNeighbor(map, nx, ny, dx, dy) ||
+            distances[next * 8 + DirectionIndex(dx, 0)] > 0 || distances[next * 8 + DirectionIndex(0, dy)] > 0;
+    }
+    if (jumpPoint) return 1;
+
+    int following = distances[next * 8 + dir];
+    return following > 0 ? following + 1 : following - 1;
+}
+
+void JumpTable::Build(const GridMap& map) {
+    width = map.width;
+    height = map.height;
+    if (!Supports(map)) {
+        distances.clear();
+        return;
+    }
+    distances.assign(static_cast<size_t>(map.CellCount()) * 8, 0);
+
+    // ֱ߷򣬶ԽǷһֱֵŷɨ裬֤һ
+    for (int dir = 0; dir < 8; dir++) {
+        const int dx = SEARCH_DIRECTIONS[dir][0];
+        const int dy = SEARCH_DIRECTIONS[dir][1];
+        for (int i = 0; i < height; i++) {
+            int y = dy > 0 ? height - 1 - i : i;
+            for (int j = 0; j < width; j++) {
+                int x = dx > 0 ? width - 1 - j : j;
+                distances[map.Index(x, y) * 8 + dir] = static_cast<short>(Compute(map, x, y, dir));
+            }
+        }
+    }
+}
+
+// ÿӿʼŷ㣬ֱֵٱ仯Ҳپ
+// ӰϵͶӰԶ֤ʱǰֵѾµ
+void JumpTable::Propagate(const GridMap& map, int dir, const std::vector<int>& dirty, std::vector<int>* signChanged) {
+    const int dx = SEARCH_DIRECTIONS[dir][0];
+    const int dy = SEARCH_DIRECTIONS[dir][1];
+
+    std::vector<int> order(dirty);
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return dx * (a % width) + dy * (a / width) > dx * (b % width) + dy * (b / width);
+    });
+
+    for (int start : order) {
+        int x = start % width, y = start / width;
+        while (map.InBounds(x, y)) {
+            const int cell = map.Index(x, y);
+            const int old = distances[cell * 8 + dir];
+            const int value = Compute(map, x, y, dir);
+            distances[cell * 8 + dir] = static_cast<short>(value);
+
+            if (signChanged && (old > 0) != (value > 0)) signChanged->push_back(cell);
+            if (value == old && !std::binary_search(dirty.begin(), dirty.end(), cell)) break;
+            x -= dx;
+            y -= dy;
+        }
+    }
+}
+
+void JumpTable::SetWall(const GridMap& map, int x, int y) {
+    SetWalls(map, std::vector<int>(1, map.Index(x, y)));
+}
+
+void JumpTable::SetWalls(const GridMap& map, const std::vector<int>& cells) {
+    if (cells.empty()) return;
+    if (!IsBuiltFor(map) || cells.size() > static_cast<size_t>(map.CellCount() / 16)) {
+        Build(map);
+        return;
+    }
+
+    // ǽڱ仯ֻӰΧ3x3ӵǿھԽƶϷ
+    std::vector<int> dirty;
+    for (int cell : cells) {
+        const int x = cell % map.width, y = cell / map.width;
+        for (int ny = y - 1; ny <= y + 1; ny++) {
+            for (int nx = x - 1; nx <= x + 1; nx++) {
+                if (map.InBounds(nx, ny)) dirty.push_back(map.Index(nx, ny));
+            }
+        }
+    }
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    // ֱֵ仯ĸӣԽ״̬Ҳ֮仯
+    std::vector<int> diagonalDirty(dirty);
+    for (int dir = 0; dir < 4; dir++) {
+        Propagate(map, dir, dirty, &diagonalDirty);
+    }
+    std::sort(diagonalDirty.begin(), diagonalDirty.end());
+    diagonalDirty.erase(std::unique(diagonalDirty.begin(), diagonalDirty.end()), diagonalDirty.end());
+
+    for (int dir = 4; dir < 8; dir++) {
+        Propagate(map, dir, diagonalDirty, nullptr);
+    }
+}
+
+bool JumpTable::FindPath(const GridMap& map, int startX, int startY, int goalX, int goalY,
+    SearchWorkspace& ws, SearchResult& result) const {
+    result.found = false;
+    result.cost = 0;
+    result.path.clear();
+    result.expanded = 0;
+
+    if (!IsBuiltFor(map) || map.IsWall(startX, startY) || map.IsWall(goalX, goalY)) return false;
+
+    const int start = map.Index(startX, startY);
+    const int goal = map.Index(goalX, goalY);
+
+    ws.Begin(map.CellCount());
+    std::vector<GridOpenEntry<int> >& openSet = ws.OpenStorage<int>();
+    openSet.clear();
+    ws.Open(start, 0, -1);
+    openSet.push_back({ OctileDistance(startX, startY, goalX, goalY), 0, start });
+    SEARCH_PROFILE_PUSH(ws, startX, startY);
+
+    auto push = [&](int from, int x, int y, int steps, int dir) {
+        const int to = map.Index(x, y);
+        if (ws.IsClosed(to)) return;
+        const int newG = ws.g[from] + steps * MoveCost(dir);
+        if (newG >= ws.G(to)) return;
+        ws.Open(to, newG, from);
+        openSet.push_back({ newG + OctileDistance(x, y, goalX, goalY), newG, to });
+        std::push_heap(openSet.begin(), openSet.end());
+        SEARCH_PROFILE_PUSH(ws, x, y);
+    };
+
+    bool found = false;
+    while (!openSet.empty()) {
+        std::pop_heap(openSet.begin(), openSet.end());
+        const GridOpenEntry<int> top = openSet.back();
+        openSet.pop_back();
+        const int cell = top.cell;
+        if (ws.IsClosed(cell)) continue;
+        ws.Close(cell);
+        result.expanded++;
+        SEARCH_PROFILE_EXPAND(ws, cell % map.width, cell / map.width);
+
+        if (cell == goal) {
+            found = true;
+            break;
+        }
+
+        const int x = cell % map.width, y = cell / map.width;
+
+        // 뷽֦㿼ȫֻȻھǿھ
+        int dirs[8];
+        int dirCount = 0;
+        const int parent = ws.Parent(cell);
+        if (parent < 0) {
+            for (int d = 0; d < 8; d++) dirs[dirCount++] = d;
+        }
+        else {
+            const int dx = Sign(x - parent % map.width);
+            const int dy = Sign(y - parent / map.width);
+            if (dx == 0 || dy == 0) {
+                dirs[dirCount++] = DirectionIndex(dx, dy);
+                for (int side = -1; side <= 1; side += 2) {
+                    int px = dy != 0 ? side : 0;
+                    int py = dx != 0 ? side : 0;
+                    if (map.IsWall(x + px, y + py)) dirs[dirCount++] = DirectionIndex(dx + px, dy + py);
+                }
+            }
+            else {
+                dirs[dirCount++] = DirectionIndex(dx, dy);
+                dirs[dirCount++] = DirectionIndex(dx, 0);
+                dirs[dirCount++] = DirectionIndex(0, dy);
+                if (map.IsWall(x - dx, y)) dirs[dirCount++] = DirectionIndex(-dx, dy);
+                if (map.IsWall(x, y - dy)) dirs[dirCount++] = DirectionIndex(dx, -dy);
+            }
+        }
+
+        const int goalDx = goalX - x, goalDy = goalY - y;
+        for (int i = 0; i < dirCount; i++) {
+            const int dir = dirs[i];
+            const int dx = SEARCH_DIRECTIONS[dir][0];
+            const int dy = SEARCH_DIRECTIONS[dir][1];
+            const int distance = distances[cell * 8 + dir];
+            const int reach = distance > 0 ? distance : -distance;
+
+            if (dir < 4) {
+                // յֱҲԾΧʱֱյ
+                const int steps = dx != 0 ? goalDx * dx : goalDy * dy;
+                const bool onLine = dx != 0 ? goalDy == 0 : goalDx == 0;
+                if (onLine && steps > 0 && steps <= reach) {
+                    push(cell, goalX, goalY, steps, dir);
+                    continue;
+                }
+            }
+            else if (Sign(goalDx) == dx && Sign(goalDy) == dy) {
+                // յڸöԽǷָڣߵյͬлͬеĸ
+                const int steps = std::min(abs(goalDx), abs(goalDy));
+                if (steps <= reach) {
+                    push(cell, x + steps * dx, y + steps * dy, steps, dir);
+                    continue;
+                }
+            }
+            if (distance > 0) push(cell, x + distance * dx, y + distance * dy, distance, dir);
+        }
+    }
+
+    if (!found) return false;
+
+    // յݣÿֱ߻Խչ巴תҪб
+    for (int p = goal; p != start; p = ws.Parent(p)) {
+        const int parent = ws.Parent(p);
+        int x = p % map.width, y = p / map.width;
+        const int tx = parent % map.width, ty = parent / map.width;
+        const int dx = Sign(tx - x), dy = Sign(ty - y);
+        while (x != tx || y != ty) {
+            result.path.push_back(map.Index(x, y));
+            x += dx;
+            y += dy;
+        }
+    }
+    result.path.push_back(start);
+    std::reverse(result.path.begin(), result.path.end());
+    result.found = true;
+    result.cost = ws.G(goal);
+    return true;
+}
+
+std::string JumpTable::Serialize(const GridMap& map) const {
+    ChunkWriter writer;
+    writer.WriteInt(width);
+    writer.WriteInt(height);
+    writer.WriteUInt(HashWalls(map));
+    writer.WriteInt(static_cast<int32_t>(distances.size()));
+    if (!distances.empty()) writer.Append(distances.data(), distances.size() * sizeof(short));
+    return writer.Sealed();
+}
+
+bool JumpTable::Deserialize(const std::string& payload, const GridMap& map) {
+    ChunkReader reader(payload);
+    reader.Unseal();
+    int readWidth = reader.ReadInt();
+    int readHeight = reader.ReadInt();
+    uint32_t readHash = reader.ReadUInt();
+    int count = reader.ReadInt();
+    if (reader.Failed() || !Supports(map) || readWidth != map.width || readHeight != map.height ||
+        readHash != HashWalls(map) || count != map.CellCount() * 8) {
+        return false;
+    }
+
+    std::vector<short> values(count);
+    reader.Read(values.data(), values.size() * sizeof(short));
+    if (!reader.AtEnd()) return false;
+
+    width = readWidth;
+    height = readHeight;
+    distances.swap(values);
+    return true;
+}
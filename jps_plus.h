@@ -0,0 +1,58 @@
+#pragma once
+
+#include "grid_map.h"
+#include "search_kernel.h"
+
+#include <string>
+#include <vector>
+
+// JPS+ԤΪÿո8¼ظ÷һľ루ǽǰĲȡ0ʾһ裩
+// ѯʱÿֻһαӦCORNER_BLOCK_BOTHнǡǽ֮бֻ֧8
+// ǽڱ仯ʱSetWallֻӰСкͶԽ£ֱֵٱ仯
+// short洢߳JUMP_TABLE_MAX_SIDEĵͼIsBuiltForΪfalseѯδҵ
+
+const int JUMP_TABLE_MAX_SIDE = 32767;
+
+class JumpTable {
+public:
+    JumpTable() : width(0), height(0) {}
+
+    // ͼߴǷshort洢Ծ
+    static bool Supports(const GridMap& map) {
+        return map.width <= JUMP_TABLE_MAX_SIDE && map.height <= JUMP_TABLE_MAX_SIDE;
+    }
+
+    void Build(const GridMap& map);
+
+    // map(x, y)ǽ״̬Ѿı
+    void SetWall(const GridMap& map, int x, int y);
+
+    // һӣǽ״̬ıͳһһΣĶռͼϴʱֱؽ
+    void SetWalls(const GridMap& map, const std::vector<int>& cells);
+
+    bool IsBuiltFor(const GridMap& map) const {
+        return width == map.width && height == map.height && !distances.empty();
+    }
+
+    // dirSEARCH_DIRECTIONS±꣩ϵԾ
+    int Distance(int cell, int dir) const { return distances[cell * 8 + dir]; }
+
+    bool FindPath(const GridMap& map, int startX, int startY, int goalX, int goalY,
+        SearchWorkspace& workspace, SearchResult& result) const;
+
+    // лΪͼļչݣ¼ǽУֵͼһ»ʱDeserializefalse
+    std::string Serialize(const GridMap& map) const;
+    bool Deserialize(const std::string& payload, const GridMap& map);
+
+    bool operator==(const JumpTable& other) const {
+        return width == other.width && height == other.height && distances == other.distances;
+    }
+
+private:
+    int Compute(const GridMap& map, int x, int y, int dir) const;
+    void Propagate(const GridMap& map, int dir, const std::vector<int>& dirty, std::vector<int>* signChanged);
+
+    int width;
+    int height;
+    std::vector<short> distances;   // cell * 8 + dir
+};
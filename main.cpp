@@ -4,13 +4,24 @@
 #include <commctrl.h>
 #include <ctime>
 #include <vector>
-#include <queue>
 #include <algorithm>
 #include <string>
 #include <sstream>
 #include <iomanip>
 #include <fstream>
 #include <functional>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+
+#include "search_stepper.h"
+#include "subgoal_graph.h"
+#include "rectangle_graph.h"
+#include "map_file.h"
+#include "jps_plus.h"
+#include "map_edit.h"
+#include "path_service.h"
+#include "verify_harness.h"
 
 // ָ - ָʹWinMainΪڵ
 #pragma comment(linker, "/SUBSYSTEM:WINDOWS")
@@ -43,26 +54,6 @@ enum ToolType {
     TOOL_ERASE = 3
 };
 
-// ڵṹ
-struct Node {
-    int x, y;
-    int g, h, f;
-    Node* parent;
-
-    Node(int x, int y) : x(x), y(y), g(0), h(0), f(0), parent(nullptr) {}
-
-    bool operator>(const Node& other) const {
-        return f > other.f;
-    }
-};
-
-// ڵȽϺ
-struct NodeCompare {
-    bool operator()(Node* a, Node* b) const {
-        return a->f > b->f;
-    }
-};
-
 // ȫֱ
 CellType grid[GRID_HEIGHT][GRID_WIDTH];
 bool isRunning = false;
@@ -80,13 +71,33 @@ HWND hToolRadio[4];
 HWND hStartButton, hStopButton, hPauseButton, hClearButton, hRandomButton, hSaveButton, hLoadButton, hExitButton, hAboutButton;
 HWND hSpeedTrackbar, hSpeedLabel;
 ToolType currentTool = TOOL_WALL;
-HANDLE hAStarThread = NULL;
+
+// ֲɶʱΪÿ߳
+const UINT_PTR SEARCH_TIMER_ID = 1;
+SearchStepper searchStepper;
+PaddedGrid searchGrid;                  // ʼʱǽڿ
+std::vector<SearchEvent> searchEvents;  // ¼
+std::vector<int> searchPath;            // ҵ·
+size_t pathAnimationIndex = 0;          // ·
+
+// JPS+wallMapgridеǽڱͬ༭ǽʱԾ
+GridMap wallMap;
+JumpTable jumpTable;
+SearchWorkspace jumpWorkspace;
+
+// ͼ༭ÿϢ޸ռͳһӦãһΰµɿıʻΪһ־¼
+EditTransaction pendingEdit(GRID_WIDTH);    // ǰϢе޸
+EditTransaction strokeEdit(GRID_WIDTH);     // ǰʻۼƵ޸
+EditJournal editJournal;
 
 // ״̬
 bool isMouseDownOnControl = false;
 bool ignoreNextMouseMove = false;
 POINT lastMousePos = { -1, -1 };  // ¼һλ
 
+// Ǽ¼ֻñĶĸӣÿͼɨ
+std::vector<POINT> searchMarkedCells;
+
 // ɫ
 COLORREF GetCellColor(CellType type) {
     switch (type) {
@@ -112,232 +123,152 @@ void UpdateUIStatus() {
     UpdateWindow(hMainWnd);
 }
 
-// ʽ루پ룩
-int CalculateHeuristic(int x1, int y1, int x2, int y2) {
-    return abs(x1 - x2) + abs(y1 - y2);
+// ػ浥
+void InvalidateCell(int x, int y) {
+    RECT rect;
+    rect.left = x * CELL_SIZE;
+    rect.top = y * CELL_SIZE;
+    rect.right = rect.left + CELL_SIZE;
+    rect.bottom = rect.top + CELL_SIZE;
+    InvalidateRect(hMainWnd, &rect, FALSE);
 }
 
-// ֹͣA*㷨
-void StopAStar() {
-    if (isRunning) {
-        isRunning = false;
-        isPaused = false;
-        if (hAStarThread) {
-            // ߳һЩʱ˳
-            DWORD waitResult = WaitForSingleObject(hAStarThread, 2000);
-            if (waitResult == WAIT_TIMEOUT) {
-                // ̳߳ʱδ˳ǿֹ
-                TerminateThread(hAStarThread, 0);
-            }
-            CloseHandle(hAStarThread);
-            hAStarThread = NULL;
-        }
-
-        for (int y = 0; y < GRID_HEIGHT; y++) {
-            for (int x = 0; x < GRID_WIDTH; x++) {
-                if (grid[y][x] != CELL_WALL && grid[y][x] != CELL_START && grid[y][x] != CELL_END) {
-                    grid[y][x] = CELL_EMPTY;
-                }
-            }
-        }
-
-        InvalidateRect(hMainWnd, NULL, TRUE);
-        UpdateUIStatus(); // UI״̬
-    }
+// ӱΪ״̬ѷ/б/·¼Ա֮
+void MarkSearchCell(int x, int y, CellType type) {
+    grid[y][x] = type;
+    searchMarkedCells.push_back({ x, y });
 }
 
-// ڵڴĸ - ʹģֲ֧ͬ͵ȶ
-template<typename QueueType>
-void CleanupNodes(QueueType& openSet) {
-    while (!openSet.empty()) {
-        delete openSet.top();
-        openSet.pop();
+// һµıǣ뱻ǵĸ
+void ClearSearchMarks() {
+    for (size_t i = 0; i < searchMarkedCells.size(); i++) {
+        POINT cell = searchMarkedCells[i];
+        CellType type = grid[cell.y][cell.x];
+        if (type == CELL_PATH || type == CELL_VISITED || type == CELL_OPEN) {
+            grid[cell.y][cell.x] = CELL_EMPTY;
+            InvalidateCell(cell.x, cell.y);
+        }
     }
+    searchMarkedCells.clear();
 }
 
-// A*㷨ʵ
-DWORD WINAPI AStarSearch(LPVOID lpParam) {
-    pathFound = false;
-
-    // ÷ǽ㡢յĸ
+// ǰͼǽڲ
+GridMap CurrentWallMap() {
+    GridMap map(GRID_WIDTH, GRID_HEIGHT);
     for (int y = 0; y < GRID_HEIGHT; y++) {
         for (int x = 0; x < GRID_WIDTH; x++) {
-            if (grid[y][x] != CELL_WALL && grid[y][x] != CELL_START && grid[y][x] != CELL_END) {
-                grid[y][x] = CELL_EMPTY;
-            }
+            map.walls[map.Index(x, y)] = grid[y][x] == CELL_WALL ? 1 : 0;
         }
     }
+    return map;
+}
 
-    std::priority_queue<Node*, std::vector<Node*>, NodeCompare> openSet;
-    bool closedSet[GRID_HEIGHT][GRID_WIDTH] = { false };
-
-    Node* startNode = new Node(startPos.x, startPos.y);
-    startNode->h = CalculateHeuristic(startPos.x, startPos.y, endPos.x, endPos.y);
-    startNode->f = startNode->h;
-    openSet.push(startNode);
-
-    int directions[8][2] = { {0,1}, {1,0}, {0,-1}, {-1,0}, {1,1}, {1,-1}, {-1,1}, {-1,-1} };
-
-    while (!openSet.empty() && !isPaused && isRunning) {
-        Node* current = openSet.top();
-        openSet.pop();
-
-        if (current->x == endPos.x && current->y == endPos.y) {
-            // ҵ·ݲʾ
-            pathFound = true;
-            std::vector<Node*> pathNodes;
-            Node* pathNode = current;
-
-            // ռ·ڵ
-            while (pathNode->parent != nullptr) {
-                pathNodes.push_back(pathNode);
-                pathNode = pathNode->parent;
-            }
+// ǰͼǽͬõĴ߿ͼ
+void BuildSearchGrid() {
+    searchGrid.Build(CurrentWallMap());
+}
 
-            // ·㵽յ㣩
-            for (int i = (int)pathNodes.size() - 1; i >= 0 && isRunning && !isPaused; i--) {
-                Node* node = pathNodes[i];
-                if (grid[node->y][node->x] != CELL_END) {
-                    grid[node->y][node->x] = CELL_PATH;
-                }
+// ŵͼıأؽԾ
+void RebuildJumpTable() {
+    wallMap = CurrentWallMap();
+    jumpTable.Build(wallMap);
+}
 
-                RECT rect;
-                rect.left = node->x * CELL_SIZE;
-                rect.top = node->y * CELL_SIZE;
-                rect.right = rect.left + CELL_SIZE;
-                rect.bottom = rect.top + CELL_SIZE;
-                InvalidateRect(hMainWnd, &rect, FALSE);
-                UpdateWindow(hMainWnd);
+// JPS+Ծ·ʾ𲽶
+void RunJumpPointSearch() {
+    ClearSearchMarks();
 
-                // ʹûƵٶ
-                Sleep(visualizationSpeed);
+    SearchResult result;
+    if (!jumpTable.FindPath(wallMap, startPos.x, startPos.y, endPos.x, endPos.y, jumpWorkspace, result)) {
+        PostMessage(hMainWnd, WM_USER + 1, 0, 0); // 0ʾδҵ·
+        return;
+    }
 
-                if (isPaused) {
-                    while (isPaused && isRunning) {
-                        Sleep(100);
-                    }
-                }
-            }
+    for (size_t i = 0; i < result.path.size(); i++) {
+        int x = result.path[i] % GRID_WIDTH;
+        int y = result.path[i] / GRID_WIDTH;
+        if (grid[y][x] == CELL_START || grid[y][x] == CELL_END) continue;
 
-            // ڴ
-            CleanupNodes(openSet);
-            delete current;
+        MarkSearchCell(x, y, CELL_PATH);
+        InvalidateCell(x, y);
+    }
+}
 
-            isRunning = false;
-            isPaused = false;
-            UpdateUIStatus(); // UI״̬
+// ʼA*㷨֮ɶʱÿƽһ
+void StartAStar() {
+    ClearSearchMarks();
+    BuildSearchGrid();
+    searchStepper.Start(searchGrid, startPos.x, startPos.y, endPos.x, endPos.y);
+    searchPath.clear();
+    pathAnimationIndex = 0;
+    pathFound = false;
 
-            return 0;
-        }
+    isRunning = true;
+    isPaused = false;
+    SetTimer(hMainWnd, SEARCH_TIMER_ID, visualizationSpeed, NULL);
+    UpdateUIStatus(); // UI״̬
+}
 
-        closedSet[current->y][current->x] = true;
+// A*㷨ҵ··
+void FinishAStar() {
+    KillTimer(hMainWnd, SEARCH_TIMER_ID);
+    isRunning = false;
+    isPaused = false;
+    UpdateUIStatus(); // UI״̬
+}
 
-        if (grid[current->y][current->x] != CELL_START && showVisited) {
-            grid[current->y][current->x] = CELL_VISITED;
+// ֹͣA*㷨
+void StopAStar() {
+    if (isRunning) {
+        FinishAStar();
+        ClearSearchMarks();
+        InvalidateRect(hMainWnd, NULL, TRUE);
+    }
+}
 
-            RECT rect;
-            rect.left = current->x * CELL_SIZE;
-            rect.top = current->y * CELL_SIZE;
-            rect.right = rect.left + CELL_SIZE;
-            rect.bottom = rect.top + CELL_SIZE;
-            InvalidateRect(hMainWnd, &rect, FALSE);
+// ʱƽһչһڵ㣬ҵ·ÿλһ·
+void AdvanceAStar() {
+    if (!isRunning || isPaused) return;
+
+    if (pathFound) {
+        // ·㵽յ㣩
+        while (pathAnimationIndex < searchPath.size()) {
+            int cell = searchPath[pathAnimationIndex++];
+            int x = cell % GRID_WIDTH;
+            int y = cell / GRID_WIDTH;
+            if (grid[y][x] == CELL_START || grid[y][x] == CELL_END) continue;
+
+            MarkSearchCell(x, y, CELL_PATH);
+            InvalidateCell(x, y);
+            return;
         }
+        FinishAStar();
+        return;
+    }
 
-        for (int i = 0; i < 8; i++) {
-            int newX = current->x + directions[i][0];
-            int newY = current->y + directions[i][1];
-
-            if (newX < 0 || newX >= GRID_WIDTH || newY < 0 || newY >= GRID_HEIGHT)
-                continue;
-
-            if (grid[newY][newX] == CELL_WALL || closedSet[newY][newX])
-                continue;
-
-            // ԽƶǷֱǽ赲
-            if (i >= 4) { // Խƶ
-                int dx1 = directions[i][0], dy1 = 0;
-                int dx2 = 0, dy2 = directions[i][1];
-
-                // ڵֱλöǽܶԽƶ
-                if (grid[current->y + dy1][current->x + dx1] == CELL_WALL &&
-                    grid[current->y + dy2][current->x + dx2] == CELL_WALL) {
-                    continue;
-                }
-            }
-
-            int newG = current->g + ((i < 4) ? 10 : 14);
-
-            // ǷѾڿб
-            bool inOpenSet = false;
-            std::vector<Node*> tempNodes;
-
-            // ʱ洢
-            while (!openSet.empty()) {
-                Node* node = openSet.top();
-                openSet.pop();
-                tempNodes.push_back(node);
-
-                if (node->x == newX && node->y == newY) {
-                    inOpenSet = true;
-                    if (newG < node->g) {
-                        node->g = newG;
-                        node->f = node->g + node->h;
-                        node->parent = current;
-                    }
-                    break;
-                }
-            }
-
-            // ָȶ
-            for (size_t j = 0; j < tempNodes.size(); j++) {
-                openSet.push(tempNodes[j]);
-            }
+    searchEvents.clear();
+    SearchStatus status = searchStepper.Step(1, &searchEvents);
 
-            if (!inOpenSet) {
-                Node* neighbor = new Node(newX, newY);
-                neighbor->g = newG;
-                neighbor->h = CalculateHeuristic(newX, newY, endPos.x, endPos.y);
-                neighbor->f = neighbor->g + neighbor->h;
-                neighbor->parent = current;
-
-                if (grid[newY][newX] != CELL_START && grid[newY][newX] != CELL_END && showVisited) {
-                    grid[newY][newX] = CELL_OPEN;
-
-                    RECT rect;
-                    rect.left = newX * CELL_SIZE;
-                    rect.top = newY * CELL_SIZE;
-                    rect.right = rect.left + CELL_SIZE;
-                    rect.bottom = rect.top + CELL_SIZE;
-                    InvalidateRect(hMainWnd, &rect, FALSE);
-                }
+    if (showVisited) {
+        for (size_t i = 0; i < searchEvents.size(); i++) {
+            int x = searchEvents[i].cell % GRID_WIDTH;
+            int y = searchEvents[i].cell / GRID_WIDTH;
+            if (grid[y][x] == CELL_START || grid[y][x] == CELL_END) continue;
 
-                openSet.push(neighbor);
-            }
-        }
-
-        UpdateWindow(hMainWnd);
-        Sleep(visualizationSpeed);
-
-        if (isPaused) {
-            while (isPaused && isRunning) {
-                Sleep(100);
-            }
+            MarkSearchCell(x, y, searchEvents[i].type == SEARCH_EVENT_EXPAND ? CELL_VISITED : CELL_OPEN);
+            InvalidateCell(x, y);
         }
     }
 
-    // ڴ
-    CleanupNodes(openSet);
-
-    // Ƿûҵ·
-    if (!pathFound && isRunning) {
+    if (status == SEARCH_FOUND) {
+        pathFound = true;
+        searchStepper.GetPath(searchPath);
+        pathAnimationIndex = 0;
+    }
+    else if (status == SEARCH_NOT_FOUND) {
+        FinishAStar();
         PostMessage(hMainWnd, WM_USER + 1, 0, 0); // 0ʾδҵ·
     }
-
-    isRunning = false;
-    isPaused = false;
-    UpdateUIStatus(); // UI״̬
-
-    return 0;
 }
 
 // ͼ
@@ -418,6 +349,21 @@ void SaveMap() {
             }
             file.write(reinterpret_cast<const char*>(&startPos), sizeof(POINT));
             file.write(reinterpret_cast<const char*>(&endPos), sizeof(POINT));
+
+            // ĿͼԾվηֽ⣬ʱԤɰ汾ȡʱԣ
+            GridMap map = CurrentWallMap();
+            SubgoalGraph subgoals;
+            subgoals.Build(map);
+            RectangleGraph rectangles;
+            rectangles.Build(map);
+            std::vector<MapChunk> chunks(3);
+            chunks[0].tag = MAP_CHUNK_SUBGOAL_GRAPH;
+            chunks[0].payload = subgoals.Serialize();
+            chunks[1].tag = MAP_CHUNK_JUMP_TABLE;
+            chunks[1].payload = jumpTable.Serialize(map);
+            chunks[2].tag = MAP_CHUNK_RECTANGLES;
+            chunks[2].payload = rectangles.Serialize(map);
+            WriteMapChunks(file, chunks);
             file.close();
         }
     }
@@ -452,8 +398,28 @@ void LoadMap() {
             }
             file.read(reinterpret_cast<char*>(&startPos), sizeof(POINT));
             file.read(reinterpret_cast<char*>(&endPos), sizeof(POINT));
+            std::vector<MapChunk> chunks;
+            ReadMapChunks(file, chunks);
             file.close();
 
+            // ļͼһµԾʱֱʹãؽ
+            wallMap = CurrentWallMap();
+            const MapChunk* jumpChunk = FindMapChunk(chunks, MAP_CHUNK_JUMP_TABLE);
+            if (!jumpChunk || !jumpTable.Deserialize(jumpChunk->payload, wallMap)) {
+                jumpTable.Build(wallMap);
+            }
+            editJournal.Clear();
+
+            // ļпܴбʱǣ¼Ա´ʱ
+            searchMarkedCells.clear();
+            for (int y = 0; y < GRID_HEIGHT; y++) {
+                for (int x = 0; x < GRID_WIDTH; x++) {
+                    if (grid[y][x] == CELL_PATH || grid[y][x] == CELL_VISITED || grid[y][x] == CELL_OPEN) {
+                        searchMarkedCells.push_back({ x, y });
+                    }
+                }
+            }
+
             hasStart = (startPos.x != -1 && startPos.y != -1);
             hasEnd = (endPos.x != -1 && endPos.y != -1);
 
@@ -592,6 +558,98 @@ void DrawUI(HDC hdc) {
     DeleteObject(hFont);
 }
 
+// ޸һӲ뵱ǰػFlushMapEditͳһ
+void SetMapCell(int x, int y, CellType type) {
+    pendingEdit.Set(y * GRID_WIDTH + x, static_cast<unsigned char>(grid[y][x]), static_cast<unsigned char>(type));
+    grid[y][x] = type;
+}
+
+// һ޸дgridԾ仯ػһΣյ仯ʱˢ½
+void NotifyMapEdit(const EditTransaction& edit) {
+    if (edit.Empty()) return;
+
+    std::vector<int> wallCells;
+    bool markerChanged = false;
+    for (const CellDelta& delta : edit.Deltas()) {
+        if ((delta.before == CELL_WALL) != (delta.after == CELL_WALL)) {
+            wallMap.walls[delta.cell] = delta.after == CELL_WALL ? 1 : 0;
+            wallCells.push_back(delta.cell);
+        }
+        if (delta.before == CELL_START || delta.before == CELL_END || delta.after == CELL_START || delta.after == CELL_END) {
+            markerChanged = true;
+        }
+    }
+    jumpTable.SetWalls(wallMap, wallCells);
+
+    const EditRegion& region = edit.Region();
+    RECT rect;
+    rect.left = region.minX * CELL_SIZE;
+    rect.top = region.minY * CELL_SIZE;
+    rect.right = (region.maxX + 1) * CELL_SIZE;
+    rect.bottom = (region.maxY + 1) * CELL_SIZE;
+    InvalidateRect(hMainWnd, &rect, FALSE);
+
+    if (markerChanged) {
+        UpdateUIStatus();
+    }
+}
+
+// ӦõǰϢռ޸ģ뵱ǰʻ
+void FlushMapEdit() {
+    pendingEdit.Normalize();
+    NotifyMapEdit(pendingEdit);
+    strokeEdit.Append(pendingEdit);
+    pendingEdit.Clear();
+}
+
+// ʻʻΪһ޸ļ־
+void CommitStroke() {
+    FlushMapEdit();
+    editJournal.Record(strokeEdit);
+    strokeEdit.Clear();
+}
+
+// ־ȡ޸дgrid޸ͬյ
+void ApplyMapEdit(const EditTransaction& edit) {
+    for (const CellDelta& delta : edit.Deltas()) {
+        int x = delta.cell % GRID_WIDTH;
+        int y = delta.cell / GRID_WIDTH;
+        grid[y][x] = static_cast<CellType>(delta.after);
+
+        if (delta.before == CELL_START && startPos.x == x && startPos.y == y) {
+            hasStart = false;
+            startPos = { -1, -1 };
+        }
+        if (delta.before == CELL_END && endPos.x == x && endPos.y == y) {
+            hasEnd = false;
+            endPos = { -1, -1 };
+        }
+        if (delta.after == CELL_START) {
+            hasStart = true;
+            startPos = { x, y };
+        }
+        if (delta.after == CELL_END) {
+            hasEnd = true;
+            endPos = { x, y };
+        }
+    }
+}
+
+// һεͼ༭Ctrl+Z / Ctrl+Y
+void UndoMapEdit(bool redo) {
+    if (redo ? !editJournal.CanRedo() : !editJournal.CanUndo()) return;
+
+    // ȥǣ֤gridֻʣ־¼ĸ
+    StopAStar();
+    ClearSearchMarks();
+
+    EditTransaction edit;
+    if (redo) editJournal.Redo(edit);
+    else editJournal.Undo(edit);
+    ApplyMapEdit(edit);
+    NotifyMapEdit(edit);
+}
+
 // ͼ
 void HandleMapClick(int x, int y, bool isDragging) {
     if (x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT) return;
@@ -599,23 +657,17 @@ void HandleMapClick(int x, int y, bool isDragging) {
     switch (currentTool) {
     case TOOL_WALL:
         if (grid[y][x] == CELL_EMPTY) {
-            grid[y][x] = CELL_WALL;
+            SetMapCell(x, y, CELL_WALL);
         }
         break;
 
     case TOOL_START:
         if (!hasStart && grid[y][x] == CELL_EMPTY) {
             if (hasStart) {
-                grid[startPos.y][startPos.x] = CELL_EMPTY;
-                RECT rect;
-                rect.left = startPos.x * CELL_SIZE;
-                rect.top = startPos.y * CELL_SIZE;
-                rect.right = rect.left + CELL_SIZE;
-                rect.bottom = rect.top + CELL_SIZE;
-                InvalidateRect(hMainWnd, &rect, FALSE);
+                SetMapCell(startPos.x, startPos.y, CELL_EMPTY);
             }
             startPos = { x, y };
-            grid[y][x] = CELL_START;
+            SetMapCell(x, y, CELL_START);
             hasStart = true;
         }
         else if (hasStart && !isDragging) {
@@ -626,16 +678,10 @@ void HandleMapClick(int x, int y, bool isDragging) {
     case TOOL_END:
         if (!hasEnd && grid[y][x] == CELL_EMPTY) {
             if (hasEnd) {
-                grid[endPos.y][endPos.x] = CELL_EMPTY;
-                RECT rect;
-                rect.left = endPos.x * CELL_SIZE;
-                rect.top = endPos.y * CELL_SIZE;
-                rect.right = rect.left + CELL_SIZE;
-                rect.bottom = rect.top + CELL_SIZE;
-                InvalidateRect(hMainWnd, &rect, FALSE);
+                SetMapCell(endPos.x, endPos.y, CELL_EMPTY);
             }
             endPos = { x, y };
-            grid[y][x] = CELL_END;
+            SetMapCell(x, y, CELL_END);
             hasEnd = true;
         }
         else if (hasEnd && !isDragging) {
@@ -645,38 +691,20 @@ void HandleMapClick(int x, int y, bool isDragging) {
 
     case TOOL_ERASE:
         if (grid[y][x] == CELL_WALL) {
-            grid[y][x] = CELL_EMPTY;
+            SetMapCell(x, y, CELL_EMPTY);
         }
         else if (grid[y][x] == CELL_START) {
-            grid[y][x] = CELL_EMPTY;
+            SetMapCell(x, y, CELL_EMPTY);
             hasStart = false;
             startPos = { -1, -1 };
         }
         else if (grid[y][x] == CELL_END) {
-            grid[y][x] = CELL_EMPTY;
+            SetMapCell(x, y, CELL_EMPTY);
             hasEnd = false;
             endPos = { -1, -1 };
         }
         break;
     }
-
-    RECT rect;
-    rect.left = x * CELL_SIZE;
-    rect.top = y * CELL_SIZE;
-    rect.right = rect.left + CELL_SIZE;
-    rect.bottom = rect.top + CELL_SIZE;
-    InvalidateRect(hMainWnd, &rect, FALSE);
-
-    // ֻе״̬ıʱػUI
-    static bool lastHasStart = false;
-    static bool lastHasEnd = false;
-
-    if (hasStart != lastHasStart || hasEnd != lastHasEnd) {
-        UpdateUIStatus(); // ʹµUIº
-
-        lastHasStart = hasStart;
-        lastHasEnd = hasEnd;
-    }
 }
 
 // ֱ֮ߣмĵԪ
@@ -719,6 +747,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
                 grid[y][x] = CELL_EMPTY;
             }
         }
+        RebuildJumpTable();
 
         // ʼͨÿؼ
         INITCOMMONCONTROLSEX icex;
@@ -781,6 +810,12 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         }
         break;
 
+    case WM_TIMER:
+        if (wParam == SEARCH_TIMER_ID) {
+            AdvanceAStar();
+        }
+        break;
+
     case WM_ERASEBKGND:
         return 1;
 
@@ -837,10 +872,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
                 MessageBox(hWnd, L"Ѱ·ڽУ", L"ʾ", MB_OK | MB_ICONINFORMATION);
                 break;
             }
-            isRunning = true;
-            isPaused = false;
-            hAStarThread = CreateThread(NULL, 0, AStarSearch, NULL, 0, NULL);
-            UpdateUIStatus(); // UI״̬
+            StartAStar();
             break;
 
         case 105: // ֹͣ
@@ -854,24 +886,27 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             }
             break;
 
-        case 107: // յͼ
+        case 107: // յͼΪһα༭־Գ
             StopAStar();
+            ClearSearchMarks();
             for (int y = 0; y < GRID_HEIGHT; y++) {
                 for (int x = 0; x < GRID_WIDTH; x++) {
-                    grid[y][x] = CELL_EMPTY;
+                    if (grid[y][x] != CELL_EMPTY) SetMapCell(x, y, CELL_EMPTY);
                 }
             }
             hasStart = false;
             hasEnd = false;
             startPos = { -1, -1 };
             endPos = { -1, -1 };
-            InvalidateRect(hWnd, NULL, TRUE);
+            CommitStroke();
             UpdateUIStatus(); // UI״̬
             break;
 
         case 108: // ͼ
             StopAStar();
             GenerateRandomMap();
+            RebuildJumpTable();
+            editJournal.Clear();
             InvalidateRect(hWnd, NULL, TRUE);
             UpdateUIStatus(); // UI״̬
             break;
@@ -911,6 +946,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             int pos = (int)SendMessage(hSpeedTrackbar, TBM_GETPOS, 0, 0);
             // ޸ٶӳ乫ʽ
             visualizationSpeed = 110 - pos * 10;  // 1=100ms, 10=10ms
+            if (isRunning) {
+                SetTimer(hWnd, SEARCH_TIMER_ID, visualizationSpeed, NULL);
+            }
             UpdateUIStatus(); // UI״̬
         }
         break;
@@ -934,6 +972,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             int gridY = y / CELL_SIZE;
             lastMousePos = { gridX, gridY };
             HandleMapClick(gridX, gridY, false);
+            FlushMapEdit();
             SetCapture(hWnd);
         }
     }
@@ -960,6 +999,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 
             // ʹֱ߻ƶ·ееԪ
             DrawLineBetweenPoints(lastMousePos.x, lastMousePos.y, gridX, gridY);
+            FlushMapEdit();
 
             // λ
             lastMousePos = { gridX, gridY };
@@ -970,6 +1010,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
     case WM_LBUTTONUP:
         if (isDragging) {
             isDragging = false;
+            CommitStroke();
             ReleaseCapture();
         }
         isMouseDownOnControl = false;
@@ -979,10 +1020,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         switch (wParam) {
         case 'S': case 's': // ʼѰ·
             if (!isRunning && hasStart && hasEnd) {
-                isRunning = true;
-                isPaused = false;
-                hAStarThread = CreateThread(NULL, 0, AStarSearch, NULL, 0, NULL);
-                UpdateUIStatus(); // UI״̬
+                StartAStar();
             }
             break;
 
@@ -996,6 +1034,24 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         case 'T': case 't': // ֹͣ
             StopAStar();
             break;
+
+        case 'J': case 'j': // JPS+Ծ·
+            if (!isRunning && hasStart && hasEnd) {
+                RunJumpPointSearch();
+            }
+            break;
+
+        case 'Z': case 'z': // Ctrl+Z ͼ༭
+            if (GetKeyState(VK_CONTROL) < 0 && !isDragging) {
+                UndoMapEdit(false);
+            }
+            break;
+
+        case 'Y': case 'y': // Ctrl+Y ͼ༭
+            if (GetKeyState(VK_CONTROL) < 0 && !isDragging) {
+                UndoMapEdit(true);
+            }
+            break;
         }
         break;
 
@@ -1010,10 +1066,61 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
     return 0;
 }
 
+// ȡ "--name=value" ʽѡ
+long long GetCommandLineOption(const char* cmdLine, const char* name, long long defaultValue) {
+    const char* found = strstr(cmdLine, name);
+    if (found == NULL) return defaultValue;
+    return _atoi64(found + strlen(name));
+}
+
+// ڳĬûп̨׼δضʱӸ̵Ŀ̨
+void AttachParentConsole() {
+    HANDLE hInput = GetStdHandle(STD_INPUT_HANDLE);
+    HANDLE hOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+    bool needInput = hInput == NULL || hInput == INVALID_HANDLE_VALUE;
+    bool needOutput = hOutput == NULL || hOutput == INVALID_HANDLE_VALUE;
+    if ((needInput || needOutput) && AttachConsole(ATTACH_PARENT_PROCESS)) {
+        FILE* stream;
+        if (needInput) freopen_s(&stream, "CONIN$", "r", stdin);
+        if (needOutput) freopen_s(&stream, "CONOUT$", "w", stdout);
+    }
+}
+
+// ģʽڣӱ׼жȡJSON󣬽д׼
+int RunServiceMode(const char* cmdLine) {
+    AttachParentConsole();
+
+    PathServiceOptions options;
+    options.workerThreads = static_cast<int>(GetCommandLineOption(cmdLine, "--threads=", 0));
+    options.batchWindowMicros = GetCommandLineOption(cmdLine, "--batch-window-us=", options.batchWindowMicros);
+    return RunPathService(std::cin, std::cout, options);
+}
+
+// ģʽͼȷԼ»ع飬д׼
+int RunVerifyMode(const char* cmdLine) {
+    AttachParentConsole();
+
+    VerifyOptions options;
+    options.seed = static_cast<unsigned int>(GetCommandLineOption(cmdLine, "--seed=", options.seed));
+    options.mapsPerConfig = static_cast<int>(GetCommandLineOption(cmdLine, "--maps=", options.mapsPerConfig));
+    options.regressionThreshold = GetCommandLineOption(cmdLine, "--threshold-pct=", 25) / 100.0;
+    options.updateBaseline = strstr(cmdLine, "--update-baseline") != NULL;
+    return RunVerifyHarness(std::cout, options);
+}
+
 // Ӧóڵ
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
     hInst = hInstance;
 
+    // ģʽa-star-visualizer.exe --serve [--threads=N] [--batch-window-us=N] < requests.jsonl
+    if (strstr(lpCmdLine, "--serve") != NULL) {
+        return RunServiceMode(lpCmdLine);
+    }
+    // ģʽa-star-visualizer.exe --verify [--seed=N] [--maps=N] [--threshold-pct=N] [--update-baseline]
+    if (strstr(lpCmdLine, "--verify") != NULL) {
+        return RunVerifyMode(lpCmdLine);
+    }
+
     // עᴰ
     WNDCLASSEX wcex;
     wcex.cbSize = sizeof(WNDCLASSEX);
@@ -0,0 +1,191 @@
+#include "map_edit.h"
+
+#include <algorithm>
+
+void EditRegion::Include(int x, int y) {
+    if (Empty()) {
+        minX = maxX = x;
+        minY = maxY = y;
+        return;
+    }
+    minX = std::min(minX, x);
+    maxX = std::max(maxX, x);
+    minY = std::min(minY, y);
+    maxY = std::max(maxY, y);
+}
+
+void EditRegion::Include(const EditRegion& other) {
+    if (other.Empty()) return;
+    Include(other.minX, other.minY);
+    Include(other.maxX, other.maxY);
+}
+
+void EditTransaction::Reset(int mapWidth) {
+    width = mapWidth;
+    Clear();
+}
+
+void EditTransaction::Clear() {
+    deltas.clear();
+    region = EditRegion();
+    normalized = true;
+}
+
+void EditTransaction::Set(int cell, unsigned char before, unsigned char after) {
+    deltas.push_back({ cell, before, after });
+    region.Include(cell % width, cell / width);
+    normalized = false;
+}
+
+void EditTransaction::Append(const EditTransaction& other) {
+    if (other.Empty()) return;
+    deltas.insert(deltas.end(), other.deltas.begin(), other.deltas.end());
+    region.Include(other.region);
+    normalized = false;
+}
+
+void EditTransaction::Normalize() {
+    if (normalized) return;
+
+    // ȶͬһڵȺ˳
+    std::stable_sort(deltas.begin(), deltas.end(), [](const CellDelta& a, const CellDelta& b) {
+        return a.cell < b.cell;
+    });
+
+    size_t out = 0;
+    for (size_t i = 0; i < deltas.size(); ) {
+        size_t j = i + 1;
+        while (j < deltas.size() && deltas[j].cell == deltas[i].cell) j++;
+        CellDelta merged = { deltas[i].cell, deltas[i].before, deltas[j - 1].after };
+        if (merged.before != merged.after) deltas[out++] = merged;
+        i = j;
+    }
+    deltas.resize(out);
+
+    region = EditRegion();
+    for (size_t i = 0; i < deltas.size(); i++) {
+        region.Include(deltas[i].cell % width, deltas[i].cell / width);
+    }
+    normalized = true;
+}
+
+void EditTransaction::Invert() {
+    for (size_t i = 0; i < deltas.size(); i++) {
+        std::swap(deltas[i].before, deltas[i].after);
+    }
+}
+
+namespace {
+
+void WriteVarint(std::vector<unsigned char>& out, size_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+size_t ReadVarint(const unsigned char*& in) {
+    size_t value = 0;
+    int shift = 0;
+    while (*in & 0x80) {
+        value |= static_cast<size_t>(*in++ & 0x7F) << shift;
+        shift += 7;
+    }
+    value |= static_cast<size_t>(*in++) << shift;
+    return value;
+}
+
+} // namespace
+
+void EditJournal::Record(EditTransaction edit) {
+    edit.Normalize();
+    if (edit.Empty()) return;
+
+    // µ޸ʹļ¼ʧЧ
+    if (position < entries.size()) {
+        stream.resize(position > firstEntry ? entries[position - 1].offset + entries[position - 1].bytes : streamStart);
+        entries.resize(position);
+    }
+
+    Entry entry;
+    entry.offset = stream.size();
+    entry.count = edit.deltas.size();
+    entry.width = edit.width;
+    entry.region = edit.region;
+
+    // 򣬼¼ǰһĲֵ
+    int previous = 0;
+    for (size_t i = 0; i < edit.deltas.size(); i++) {
+        const CellDelta& delta = edit.deltas[i];
+        WriteVarint(stream, static_cast<size_t>(delta.cell - previous));
+        stream.push_back(delta.before);
+        stream.push_back(delta.after);
+        previous = delta.cell;
+    }
+    entry.bytes = stream.size() - entry.offset;
+    entries.push_back(entry);
+    position = entries.size();
+
+    while (Bytes() > capacity && entries.size() - firstEntry > 1) DropOldest();
+    if (streamStart > Bytes()) Compact();
+}
+
+void EditJournal::DropOldest() {
+    streamStart += entries[firstEntry].bytes;
+    firstEntry++;
+    if (position < firstEntry) position = firstEntry;
+}
+
+// Ѷļ¼ֻڶֽڶʣֽʱãɶļ¼̯
+void EditJournal::Compact() {
+    stream.erase(stream.begin(), stream.begin() + streamStart);
+    entries.erase(entries.begin(), entries.begin() + firstEntry);
+    for (size_t i = 0; i < entries.size(); i++) entries[i].offset -= streamStart;
+    position -= firstEntry;
+    firstEntry = 0;
+    streamStart = 0;
+}
+
+void EditJournal::Decode(const Entry& entry, EditTransaction& edit) const {
+    edit.Reset(entry.width);
+    edit.deltas.resize(entry.count);
+
+    const unsigned char* in = stream.data() + entry.offset;
+    int cell = 0;
+    for (size_t i = 0; i < entry.count; i++) {
+        cell += static_cast<int>(ReadVarint(in));
+        edit.deltas[i].cell = cell;
+        edit.deltas[i].before = *in++;
+        edit.deltas[i].after = *in++;
+    }
+    edit.region = entry.region;
+    edit.normalized = true;
+}
+
+bool EditJournal::Undo(EditTransaction& edit) {
+    if (!CanUndo()) return false;
+    position--;
+    Decode(entries[position], edit);
+    edit.Invert();
+    return true;
+}
+
+bool EditJournal::Redo(EditTransaction& edit) {
+    if (!CanRedo()) return false;
+    Decode(entries[position], edit);
+    position++;
+    return true;
+}
+
+void EditJournal::Clear() {
+    entries.clear();
+    stream.clear();
+    position = 0;
+    firstEntry = 0;
+    streamStart = 0;
+}
+
+void EditJournal::GetEntry(size_t index, EditTransaction& edit) const {
+    Decode(entries[firstEntry + index], edit);
+}
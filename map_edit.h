@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// ͼ༭༭־
+// һʻһνű༭ռΪ޸бһӦã
+// ṹԾػȣֻ仯֪ͨһΣύѹ־ֳ֧طš
+// ֵֽڼ¼ľ庬壨ӻΪCellTypeѯΪǽ/ǽ
+
+// ӵ޸
+struct CellDelta {
+    int cell;               // 
+    unsigned char before;
+    unsigned char after;
+};
+
+// ޸漰ľ򣨺߽磩
+struct EditRegion {
+    int minX = 0, minY = 0, maxX = -1, maxY = -1;
+
+    bool Empty() const { return maxX < minX; }
+    void Include(int x, int y);
+    void Include(const EditRegion& other);
+};
+
+class EditTransaction {
+public:
+    explicit EditTransaction(int mapWidth = 0) : width(mapWidth), normalized(true) {}
+
+    void Reset(int mapWidth);
+    void Clear();
+
+    // ¼޸ģͬһӵĶ޸NormalizeʱϲΪľֵµֵ
+    void Set(int cell, unsigned char before, unsigned char after);
+
+    // ׷һ޸ģ֮
+    void Append(const EditTransaction& other);
+
+    // 򡢺ϲظӲǰͬ޸ģO(n log n)
+    void Normalize();
+
+    // ¾ֵڳ
+    void Invert();
+
+    bool Empty() const { return deltas.empty(); }
+    size_t Size() const { return deltas.size(); }
+    int Width() const { return width; }
+    const std::vector<CellDelta>& Deltas() const { return deltas; }
+    const EditRegion& Region() const { return region; }
+
+private:
+    friend class EditJournal;
+
+    int width;
+    bool normalized;
+    std::vector<CellDelta> deltas;
+    EditRegion region;
+};
+
+// ༭־񰴸Ӳֵ䳤ţÿԼ3ֽ
+// ʱļ¼ֻǰ㣬ֽڶʣֽʱһΣ̯O(1)
+class EditJournal {
+public:
+    explicit EditJournal(size_t maxBytes = 64u << 20) : capacity(maxBytes), position(0), firstEntry(0), streamStart(0) {}
+
+    // ¼һӦõ޸ģտļ¼
+    void Record(EditTransaction edit);
+
+    // ȡҪӦõ޸ģUndoõѾת
+    bool Undo(EditTransaction& edit);
+    bool Redo(EditTransaction& edit);
+
+    bool CanUndo() const { return position > firstEntry; }
+    bool CanRedo() const { return position < entries.size(); }
+    void Clear();
+
+    // طţ˳ȡӦõĵindex¼
+    size_t AppliedCount() const { return position - firstEntry; }
+    void GetEntry(size_t index, EditTransaction& edit) const;
+
+    size_t Bytes() const { return stream.size() - streamStart; }
+
+private:
+    struct Entry {
+        size_t offset;
+        size_t bytes;
+        size_t count;
+        int width;
+        EditRegion region;
+    };
+
+    void Decode(const Entry& entry, EditTransaction& edit) const;
+    void DropOldest();
+    void Compact();
+
+    size_t capacity;
+    size_t position;                    // entries[firstEntry, position)Ӧ
+    size_t firstEntry;                  // ֮ǰļ¼Ѷȴ
+    size_t streamStart;                 // stream֮ǰֽѶ
+    std::vector<Entry> entries;         // offsetΪstreamеλ
+    std::vector<unsigned char> stream;
+};
@@ -0,0 +1,102 @@
+#include "map_file.h"
+
+#include <fstream>
+#include <algorithm>
+
+namespace {
+
+// չγļţȡʵʶֽضϻ𻵵ļᰴһ4GB
+const size_t CHUNK_READ_PIECE = 64 * 1024;
+
+} // namespace
+
+uint32_t HashBytes(const void* data, size_t size, uint32_t hash) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+uint32_t HashWalls(const GridMap& map) {
+    uint32_t hash = 2166136261u;
+    hash = (hash ^ static_cast<uint32_t>(map.width)) * 16777619u;
+    hash = (hash ^ static_cast<uint32_t>(map.height)) * 16777619u;
+    for (size_t i = 0; i < map.walls.size(); i++) {
+        hash = (hash ^ map.walls[i]) * 16777619u;
+    }
+    return hash;
+}
+
+const MapChunk* FindMapChunk(const std::vector<MapChunk>& chunks, uint32_t tag) {
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (chunks[i].tag == tag) return &chunks[i];
+    }
+    return nullptr;
+}
+
+void WriteMapChunks(std::ostream& output, const std::vector<MapChunk>& chunks) {
+    for (size_t i = 0; i < chunks.size(); i++) {
+        uint32_t length = static_cast<uint32_t>(chunks[i].payload.size());
+        output.write(reinterpret_cast<const char*>(&chunks[i].tag), sizeof(uint32_t));
+        output.write(reinterpret_cast<const char*>(&length), sizeof(uint32_t));
+        output.write(chunks[i].payload.data(), length);
+    }
+}
+
+void ReadMapChunks(std::istream& input, std::vector<MapChunk>& chunks) {
+    chunks.clear();
+    while (true) {
+        MapChunk chunk;
+        uint32_t length = 0;
+        if (!input.read(reinterpret_cast<char*>(&chunk.tag), sizeof(uint32_t))) break;
+        if (!input.read(reinterpret_cast<char*>(&length), sizeof(uint32_t))) break;
+
+        bool complete = true;
+        while (chunk.payload.size() < length) {
+            const size_t offset = chunk.payload.size();
+            const size_t piece = std::min<size_t>(CHUNK_READ_PIECE, length - offset);
+            chunk.payload.resize(offset + piece);
+            if (!input.read(&chunk.payload[offset], piece)) {
+                complete = false;
+                break;
+            }
+        }
+        if (!complete) break;
+        chunks.push_back(chunk);
+    }
+}
+
+bool LoadMapFile(const std::string& file, int width, int height, GridMap& map, std::vector<MapChunk>& chunks) {
+    std::ifstream input(file.c_str(), std::ios::binary);
+    if (!input.is_open() || width <= 0 || height <= 0) return false;
+
+    map = GridMap(width, height);
+    for (int i = 0; i < width * height; i++) {
+        int32_t cell = 0;
+        input.read(reinterpret_cast<char*>(&cell), sizeof(cell));
+        map.walls[i] = cell == 1 ? 1 : 0;
+    }
+
+    int32_t endpoints[4];
+    input.read(reinterpret_cast<char*>(endpoints), sizeof(endpoints));
+    if (!input) return false;
+
+    ReadMapChunks(input, chunks);
+    return true;
+}
+
+bool SaveMapFile(const std::string& file, const GridMap& map, const std::vector<MapChunk>& chunks) {
+    std::ofstream output(file.c_str(), std::ios::binary);
+    if (!output.is_open()) return false;
+
+    for (int i = 0; i < map.CellCount(); i++) {
+        int32_t cell = map.walls[i] ? 1 : 0;
+        output.write(reinterpret_cast<const char*>(&cell), sizeof(cell));
+    }
+    const int32_t endpoints[4] = { -1, -1, -1, -1 };
+    output.write(reinterpret_cast<const char*>(endpoints), sizeof(endpoints));
+
+    WriteMapChunks(output, chunks);
+    return static_cast<bool>(output);
+}
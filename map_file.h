@@ -0,0 +1,106 @@
+#pragma once
+
+#include "grid_map.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// ͼļʽ
+//   д洢CellTypeÿ4ֽڣǽΪ1յ㣨32λ
+//   ֮׷չΣ(4ֽ) + (4ֽ) + ݣɰ汾ȡʱЩ
+// չαԤĿͼԾվηֽ⣩м¼ǽУֵͼĶԶʧЧ
+// ĩβУֵضϻ𻵵չʧܣ¹
+
+// չα
+const uint32_t MAP_CHUNK_SUBGOAL_GRAPH = 0x32475353;  // "SSG2"
+const uint32_t MAP_CHUNK_JUMP_TABLE = 0x3253504A;     // "JPS2"
+const uint32_t MAP_CHUNK_RECTANGLES = 0x32525352;     // "RSR2"
+
+struct MapChunk {
+    uint32_t tag;
+    std::string payload;
+};
+
+// ǽڲֵУֵFNV-1aжԤǷͼһ
+uint32_t HashWalls(const GridMap& map);
+
+// չбвָ
+// ֽڵУֵFNV-1ahashǰһεĽʱɷֶμ
+uint32_t HashBytes(const void* data, size_t size, uint32_t hash = 2166136261u);
+
+const MapChunk* FindMapChunk(const std::vector<MapChunk>& chunks, uint32_t tag);
+
+// Ѵ򿪵ĵͼļĩβ׷չ
+void WriteMapChunks(std::ostream& output, const std::vector<MapChunk>& chunks);
+
+// ȡļĩβΪֹչΣĩβչζ
+void ReadMapChunks(std::istream& input, std::vector<MapChunk>& chunks);
+
+// дĵͼļֻǽڣյдΪ(-1, -1)
+bool LoadMapFile(const std::string& file, int width, int height, GridMap& map, std::vector<MapChunk>& chunks);
+bool SaveMapFile(const std::string& file, const GridMap& map, const std::vector<MapChunk>& chunks);
+
+// չݵĶд
+class ChunkWriter {
+public:
+    void WriteInt(int32_t value) { Append(&value, sizeof(value)); }
+    void WriteUInt(uint32_t value) { Append(&value, sizeof(value)); }
+    void WriteInts(const std::vector<int>& values) {
+        WriteInt(static_cast<int32_t>(values.size()));
+        if (!values.empty()) Append(values.data(), values.size() * sizeof(int));
+    }
+    void Append(const void* data, size_t size) { payload.append(static_cast<const char*>(data), size); }
+    const std::string& Payload() const { return payload; }
+    // ĩβ׷УֵȡʱChunkReader::Unseal
+    std::string Sealed() const {
+        const uint32_t hash = HashBytes(payload.data(), payload.size());
+        return payload + std::string(reinterpret_cast<const char*>(&hash), sizeof(hash));
+    }
+
+private:
+    std::string payload;
+};
+
+class ChunkReader {
+public:
+    explicit ChunkReader(const std::string& source) : payload(source), pos(0), end(source.size()), failed(false) {}
+
+    // 鲢ȥSealed׷ӵУֵһʱȡȫʧ
+    bool Unseal() {
+        uint32_t hash = 0;
+        if (failed || pos != 0 || end < sizeof(hash)) { failed = true; return false; }
+        end -= sizeof(hash);
+        payload.copy(reinterpret_cast<char*>(&hash), sizeof(hash), end);
+        if (hash != HashBytes(payload.data(), end)) failed = true;
+        return !failed;
+    }
+
+    int32_t ReadInt() { int32_t value = 0; Read(&value, sizeof(value)); return value; }
+    uint32_t ReadUInt() { uint32_t value = 0; Read(&value, sizeof(value)); return value; }
+    bool ReadInts(std::vector<int>& values) {
+        int32_t count = ReadInt();
+        if (failed || count < 0 || static_cast<size_t>(count) > (end - pos) / sizeof(int)) {
+            failed = true;
+            return false;
+        }
+        values.resize(count);
+        if (count > 0) Read(values.data(), count * sizeof(int));
+        return !failed;
+    }
+    void Read(void* data, size_t size) {
+        if (failed || end - pos < size) { failed = true; return; }
+        payload.copy(static_cast<char*>(data), size, pos);
+        pos += size;
+    }
+    bool Failed() const { return failed; }
+    // Ƿǡöȫ
+    bool AtEnd() const { return !failed && pos == end; }
+
+private:
+    const std::string& payload;
+    size_t pos;
+    size_t end;
+    bool failed;
+};
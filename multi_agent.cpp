@@ -0,0 +1,303 @@
+#include "multi_agent.h"
+#include "distance_field.h"
+
+#include <limits>
+#include <algorithm>
+
+int SpaceTimeTable::Find(uint64_t key) const {
+    if (keys.empty()) return -1;
+    const size_t mask = keys.size() - 1;
+    uint64_t hash = key * 0x9E3779B97F4A7C15ull;
+    for (size_t slot = static_cast<size_t>(hash ^ (hash >> 32)) & mask; ; slot = (slot + 1) & mask) {
+        if (keys[slot] == key) return values[slot];
+        if (keys[slot] == EMPTY_KEY) return -1;
+    }
+}
+
+void SpaceTimeTable::Set(uint64_t key, int value) {
+    if ((count + 1) * 2 > keys.size()) Grow();
+    const size_t mask = keys.size() - 1;
+    uint64_t hash = key * 0x9E3779B97F4A7C15ull;
+    for (size_t slot = static_cast<size_t>(hash ^ (hash >> 32)) & mask; ; slot = (slot + 1) & mask) {
+        if (keys[slot] == key) {
+            values[slot] = value;
+            return;
+        }
+        if (keys[slot] == EMPTY_KEY) {
+            keys[slot] = key;
+            values[slot] = value;
+            used.push_back(static_cast<uint32_t>(slot));
+            count++;
+            return;
+        }
+    }
+}
+
+void SpaceTimeTable::Clear() {
+    for (size_t i = 0; i < used.size(); i++) keys[used[i]] = EMPTY_KEY;
+    used.clear();
+    count = 0;
+}
+
+void SpaceTimeTable::Grow() {
+    std::vector<uint64_t> oldKeys;
+    std::vector<int> oldValues;
+    oldKeys.swap(keys);
+    oldValues.swap(values);
+
+    keys.assign(oldKeys.empty() ? 1024 : oldKeys.size() * 2, EMPTY_KEY);
+    values.assign(keys.size(), 0);
+    used.clear();
+    count = 0;
+    for (size_t i = 0; i < oldKeys.size(); i++) {
+        if (oldKeys[i] != EMPTY_KEY) Set(oldKeys[i], oldValues[i]);
+    }
+}
+
+void ReservationTable::Reset(int cellCount) {
+    claims.Clear();
+    parkedFrom.assign(cellCount, std::numeric_limits<int>::max());
+    visits.assign(cellCount, std::vector<int>());
+    visitMask.assign(cellCount, 0);
+}
+
+void ReservationTable::Reserve(const std::vector<int>& path) {
+    if (path.empty()) return;
+    const int arrival = static_cast<int>(path.size()) - 1;
+    for (int t = 0; t < arrival; t++) {
+        claims.Set(SpaceTimeTable::Key(path[t], t), path[t + 1]);
+        std::vector<int>& times = visits[path[t]];
+        times.insert(std::upper_bound(times.begin(), times.end(), t), t);
+        visitMask[path[t]] |= 1ull << (t & 63);
+    }
+    parkedFrom[path[arrival]] = std::min(parkedFrom[path[arrival]], arrival);
+}
+
+int ReservationTable::NextCell(int cell, int time) const {
+    if (time >= parkedFrom[cell]) return cell;
+    if (time < 0 || !((visitMask[cell] >> (time & 63)) & 1)) return -1;
+    return claims.Find(SpaceTimeTable::Key(cell, time));
+}
+
+int ReservationTable::NextOccupied(int cell, int time) const {
+    const std::vector<int>& times = visits[cell];
+    std::vector<int>::const_iterator next = std::upper_bound(times.begin(), times.end(), time);
+    const int visit = next == times.end() ? std::numeric_limits<int>::max() : *next;
+    return std::min(visit, std::max(parkedFrom[cell], time + 1));
+}
+
+int ReservationTable::NextFree(int cell, int time) const {
+    const std::vector<int>& times = visits[cell];
+    std::vector<int>::const_iterator it = std::lower_bound(times.begin(), times.end(), time);
+    while (it != times.end() && *it == time) {
+        ++it;
+        time++;
+    }
+    return time >= parkedFrom[cell] ? std::numeric_limits<int>::max() : time;
+}
+
+int ReservationTable::FreeSince(int cell, int time) const {
+    const std::vector<int>& times = visits[cell];
+    std::vector<int>::const_iterator it = std::lower_bound(times.begin(), times.end(), time);
+    return it == times.begin() ? 0 : *(it - 1) + 1;
+}
+
+int ReservationTable::ParkTime(int cell) const {
+    if (parkedFrom[cell] != std::numeric_limits<int>::max()) return std::numeric_limits<int>::max();
+    return visits[cell].empty() ? 0 : visits[cell].back() + 1;
+}
+
+bool FindSpaceTimePath(const GridMap& map, const AgentTask& task, const ReservationTable& reservations,
+    const MultiAgentOptions& options, SpaceTimeWorkspace& ws, AgentPlan& plan) {
+    plan.found = false;
+    plan.gaveUp = false;
+    plan.cost = 0;
+    plan.path.clear();
+    plan.expanded = 0;
+
+    if (map.IsWall(task.startX, task.startY) || map.IsWall(task.goalX, task.goalY)) return false;
+    const int start = map.Index(task.startX, task.startY);
+    const int goal = map.Index(task.goalX, task.goalY);
+    if (reservations.IsOccupied(start, 0)) return false;
+    // յѱͣסԶ
+    const int parkTime = reservations.ParkTime(goal);
+    if (parkTime == std::numeric_limits<int>::max()) return false;
+
+    const int horizon = options.horizon > 0 ? options.horizon
+        : std::max(parkTime, 2 * std::max(abs(task.goalX - task.startX), abs(task.goalY - task.startY))) +
+            map.width + map.height;
+
+    const size_t maxExpansions = options.maxExpansions > 0 ? options.maxExpansions
+        : static_cast<size_t>(AGENT_DEFAULT_EXPANSIONS_PER_CELL) * map.CellCount();
+
+    const bool useField = static_cast<int>(ws.goalDistance.size()) == map.CellCount();
+    if (useField && ws.goalDistance[start] == DISTANCE_UNREACHABLE) return false;
+    // յparkTime֮ǰ˾ʱ̲parkTimeÿһٻCOST_WAIT
+    auto heuristic = [&](int cell, int time) {
+        const int distance = useField ? ws.goalDistance[cell]
+            : OctileDistance(cell % map.width, cell / map.width, task.goalX, task.goalY);
+        return std::max(distance, COST_WAIT * (parkTime - time));
+    };
+
+    typedef SpaceTimeWorkspace::OpenEntry OpenEntry;
+    std::vector<OpenEntry>& openSet = ws.open;
+    openSet.clear();
+    ws.nodes.clear();
+    ws.index.Clear();
+    ws.nodes.push_back({ start, 0, 0, -1, -1, false });
+    ws.index.Set(SpaceTimeTable::Key(start, reservations.FreeSince(start, 0)), 0);
+    openSet.push_back({ heuristic(start, 0), 0, 0 });
+
+    int found = -1;
+    while (!openSet.empty()) {
+        std::pop_heap(openSet.begin(), openSet.end());
+        const OpenEntry top = openSet.back();
+        openSet.pop_back();
+        SpaceTimeWorkspace::Node& node = ws.nodes[top.node];
+        if (node.closed) continue;
+        node.closed = true;
+        plan.expanded++;
+
+        const int cell = node.cell;
+        const int time = node.time;
+        const int g = node.g;
+        if (cell == goal && reservations.CanPark(goal, time)) {
+            found = top.node;
+            break;
+        }
+        if (plan.expanded >= maxExpansions) {
+            plan.gaveUp = true;
+            break;
+        }
+
+        // ڵǰԵȵlastLeaveʱٳ
+        const int lastLeave = std::min(reservations.NextOccupied(cell, time) - 1, horizon - 1);
+        const int x = cell % map.width, y = cell / map.width;
+        for (int d = 0; d < options.search.connectivity; d++) {
+            if (!CanMove(map, x, y, d, options.search.cornerRule)) continue;
+            const int dx = SEARCH_DIRECTIONS[d][0];
+            const int dy = SEARCH_DIRECTIONS[d][1];
+            const int next = map.Index(x + dx, y + dy);
+            if (useField && ws.goalDistance[next] == DISTANCE_UNREACHABLE) continue;
+            const int sideA = map.Index(x + dx, y);
+            const int sideB = map.Index(x, y + dy);
+            const bool diagonal = dx != 0 && dy != 0;
+
+            // γĿ[time + 1, lastLeave + 1]ڵÿȫ䣬ȡ߽ȥʱ
+            int arrival = reservations.NextFree(next, time + 1);
+            while (arrival <= lastLeave + 1) {
+                const int begin = reservations.FreeSince(next, arrival);
+                const int end = std::min(reservations.NextOccupied(next, arrival) - 1, lastLeave + 1);
+                // һ򽻻Ҳб˵ĶԽ
+                while (arrival <= end) {
+                    const int leave = arrival - 1;
+                    if (!reservations.HasMove(next, cell, leave) &&
+                        !(diagonal && (reservations.HasMove(sideA, sideB, leave) || reservations.HasMove(sideB, sideA, leave)))) {
+                        break;
+                    }
+                    arrival++;
+                }
+                if (arrival <= end) {
+                    const int newG = g + COST_WAIT * (arrival - 1 - time) + MoveCost(d);
+                    const uint64_t key = SpaceTimeTable::Key(next, begin);
+                    const int head = ws.index.Find(key);
+                    // ڿԭصȴ絽ĵȵʱ̺Բ߾֧
+                    bool dominated = false;
+                    for (int other = head; other >= 0; other = ws.nodes[other].sibling) {
+                        SpaceTimeWorkspace::Node& label = ws.nodes[other];
+                        if (label.time <= arrival && label.g + COST_WAIT * (arrival - label.time) <= newG) {
+                            dominated = true;
+                            break;
+                        }
+                        if (arrival <= label.time && newG + COST_WAIT * (label.time - arrival) <= label.g) label.closed = true;
+                    }
+                    if (!dominated) {
+                        const int index = static_cast<int>(ws.nodes.size());
+                        ws.nodes.push_back({ next, arrival, newG, top.node, head, false });
+                        ws.index.Set(key, index);
+                        openSet.push_back({ newG + heuristic(next, arrival), newG, index });
+                        std::push_heap(openSet.begin(), openSet.end());
+                    }
+                }
+                arrival = reservations.NextFree(next, end + 1);
+            }
+        }
+    }
+
+    if (found < 0) return false;
+
+    // ڵֻ¼ʱ̣мĵȴڵڸӲ
+    std::vector<int> chain;
+    for (int n = found; n != -1; n = ws.nodes[n].parent) chain.push_back(n);
+    for (size_t i = chain.size(); i-- > 0;) {
+        const SpaceTimeWorkspace::Node& n = ws.nodes[chain[i]];
+        while (static_cast<int>(plan.path.size()) < n.time) plan.path.push_back(plan.path.back());
+        plan.path.push_back(n.cell);
+    }
+    plan.found = true;
+    plan.cost = ws.nodes[found].g;
+    return true;
+}
+
+namespace {
+
+// ƶͨյ㲻ͬһʱʱ
+void LabelComponents(const GridMap& map, const SearchOptions& options, std::vector<int>& component) {
+    component.assign(map.CellCount(), -1);
+    std::vector<int> stack;
+    int label = 0;
+    for (int seed = 0; seed < map.CellCount(); seed++) {
+        if (map.walls[seed] || component[seed] >= 0) continue;
+        component[seed] = label;
+        stack.push_back(seed);
+        while (!stack.empty()) {
+            const int cell = stack.back();
+            stack.pop_back();
+            const int x = cell % map.width, y = cell / map.width;
+            for (int d = 0; d < options.connectivity; d++) {
+                if (!CanMove(map, x, y, d, options.cornerRule)) continue;
+                const int next = map.Index(x + SEARCH_DIRECTIONS[d][0], y + SEARCH_DIRECTIONS[d][1]);
+                if (component[next] >= 0) continue;
+                component[next] = label;
+                stack.push_back(next);
+            }
+        }
+        label++;
+    }
+}
+
+} // namespace
+
+size_t PlanAgents(const GridMap& map, const std::vector<AgentTask>& tasks, const MultiAgentOptions& options,
+    std::vector<AgentPlan>& plans) {
+    plans.assign(tasks.size(), AgentPlan());
+
+    std::vector<int> component;
+    LabelComponents(map, options.search, component);
+
+    ReservationTable reservations;
+    reservations.Reset(map.CellCount());
+    SpaceTimeWorkspace workspace;
+    std::vector<int> goal(1);
+
+    size_t solved = 0;
+    for (size_t i = 0; i < tasks.size(); i++) {
+        const AgentTask& task = tasks[i];
+        AgentPlan& plan = plans[i];
+        if (map.IsWall(task.startX, task.startY)) continue;
+
+        const int start = map.Index(task.startX, task.startY);
+        goal[0] = map.Index(task.goalX, task.goalY);
+        const bool reachable = !map.IsWall(task.goalX, task.goalY) && component[start] == component[goal[0]];
+        if (reachable && options.fieldHeuristic) ComputeCostField(map, goal, options.search, workspace.goalDistance);
+        if (reachable && FindSpaceTimePath(map, task, reservations, options, workspace, plan)) {
+            solved++;
+        }
+        else {
+            // 滮ʧܵͣ㣬ƿ
+            plan.path.assign(1, start);
+        }
+        reservations.Reserve(plan.path);
+    }
+    return solved;
+}
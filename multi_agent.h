@@ -0,0 +1,145 @@
+#pragma once
+
+#include "grid_map.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// ·滮ʱA*ȼ滮
+// ÿһ8ƶԭصȴֱͬߣѹ滮ռü¼ԤԼУ
+// 滮ʱܿ
+//   ͻ  ͬһʱ䲽ռͬһ
+//   ͻ  ͬһʱ䲽򴩹ͬһ
+//   ͻ  ͬһʱ䲽бͬһ2x2Խ
+// յͣյ㲻ƶ˺øһֱռã
+// 滮ʧܵͣ㣬滮ܿȹ滮·Ѿøӡ
+//
+// ʱ䲽չ(, ʱ)õȴظ״̬ÿǰ˾֮ȴ
+// ״̬ȡ(, ȫ)ʱȡĿӰȫܽȥʱ̣мĵȴ·ʱ롣
+// ͬһĵܴ۸ߣб߶ࣩȴܸڱ֮ǰͨĸӣÿ䱣֧ĵ
+// ABAĴۼϵȵBĵʱ̵ĵȴBĴʱA֧Bõ·ţ
+// ûԤԼʱ뾲̬A*ȫͬ
+
+const int COST_WAIT = COST_STRAIGHT;
+
+// ĬϵĵչΪͼô౶ûԤԼʱʱA*뾲̬A*ͬչ
+// ͨյ㸽ռáֻܵȴкܾãԶСڴ
+const int AGENT_DEFAULT_EXPANSIONS_PER_CELL = 4;
+
+// (ʱ䲽, )ΪĿѰַϣֵΪint
+class SpaceTimeTable {
+public:
+    SpaceTimeTable() : count(0) {}
+
+    static uint64_t Key(int cell, int time) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(time)) << 32) | static_cast<uint32_t>(cell);
+    }
+
+    // ʱ-1
+    int Find(uint64_t key) const;
+    // 򸲸
+    void Set(uint64_t key, int value);
+    // Ԫȣ
+    void Clear();
+    size_t Size() const { return count; }
+
+private:
+    static constexpr uint64_t EMPTY_KEY = ~0ull;
+    void Grow();
+
+    std::vector<uint64_t> keys;
+    std::vector<int> values;
+    std::vector<uint32_t> used;     // ռõĲλClearʱֻЩλ
+    size_t count;
+};
+
+// ԤԼѹ滮·ռõĸ
+// ϣֻһ(, ʱ) -> һʱڸӣռúͱϵƶ
+class ReservationTable {
+public:
+    void Reset(int cellCount);
+
+    // ʱ䲽ĸеǼһ·һӵʱһֱռ
+    void Reserve(const std::vector<int>& path);
+
+    // timeʱռøøӵtime + 1ʱڵĸӣռ÷-1ͣ巵
+    int NextCell(int cell, int time) const;
+    // timeʱ̸Ƿѱռ
+    bool IsOccupied(int cell, int time) const { return NextCell(cell, time) >= 0; }
+    // timetime + 1֮˴fromߵto
+    bool HasMove(int from, int to, int time) const { return from != to && NextCell(from, time) == to; }
+    // time֮һռøøӵʱ̣û򷵻INT_MAX
+    int NextOccupied(int cell, int time) const;
+    // timeĵһʱ̣֮һֱͣסʱINT_MAX
+    int NextFree(int cell, int time) const;
+    // timeʱ̿ʱڰȫʼʱ
+    int FreeSince(int cell, int time) const;
+    // ĸʱøӲ˾ͣͣʱINT_MAX
+    int ParkTime(int cell) const;
+    bool CanPark(int cell, int time) const { return time >= ParkTime(cell); }
+
+private:
+    SpaceTimeTable claims;                  // (, ʱ) -> һʱڸ
+    std::vector<int> parkedFrom;            // ͣռøøӵʼʱ
+    std::vector<std::vector<int>> visits;   // ÿӱʱ̣
+    std::vector<uint64_t> visitMask;        // ʱģ64λͼϣ֮ǰȹ˵󲿷δռõ
+};
+
+struct AgentTask {
+    int startX, startY;
+    int goalX, goalY;
+};
+
+struct AgentPlan {
+    bool found = false;
+    bool gaveUp = false;            // ﵽչ޶û·
+    int cost = 0;                   // ƶ10/14ȴ10
+    std::vector<int> path;          // tԪΪtʱڸӣһΪյ
+    size_t expanded = 0;
+};
+
+struct MultiAgentOptions {
+    SearchOptions search;
+    int horizon = 0;                // 滮ʱ䲽0ʾյ˷յճʱ̵Ľϴߣټϵͼߣ
+    // չޣ0ʾͼAGENT_DEFAULT_EXPANSIONS_PER_CELLSIZE_MAXʾޣ
+    // ﵽ޵尴滮ʧܴ
+    size_t maxExpansions = 0;
+    // ÿComputeCostFieldյľ볡ֵԹͼչٵö࣬
+    // ÿһͼɨ裬ͼϷ
+    bool fieldHeuristic = false;
+};
+
+// ʱA*Ŀɸʱ
+struct SpaceTimeWorkspace {
+    struct Node {
+        int cell;
+        int time;                   // ʱ
+        int g;
+        int parent;
+        int sibling;                // ͬһȫһ±꣬-1ʾû
+        bool closed;                // չ֧ͬչ
+    };
+    struct OpenEntry {
+        int f;
+        int g;
+        int node;
+        bool operator<(const OpenEntry& other) const {
+            return f > other.f || (f == other.f && g < other.g);
+        }
+    };
+    std::vector<Node> nodes;
+    std::vector<OpenEntry> open;    // бѣ֮ٷڴ
+    SpaceTimeTable index;           // (, ȫʼʱ) -> ĵnodes±
+    // ѡӵյľ̴̬ۣDISTANCE_UNREACHABLEʾɴǿʱ˷Ϊֵ
+    std::vector<int> goalDistance;
+};
+
+// ԤԼʱA*ɹʱplan.pathÿʱ䲽λ
+bool FindSpaceTimePath(const GridMap& map, const AgentTask& task, const ReservationTable& reservations,
+    const MultiAgentOptions& options, SpaceTimeWorkspace& workspace, AgentPlan& plan);
+
+// ȼ滮tasks˳滮ǼԤԼسɹ滮
+// foundΪfalseյ㲻ɴյ㱻ȹ滮ͣסgaveUpΪtrue
+size_t PlanAgents(const GridMap& map, const std::vector<AgentTask>& tasks, const MultiAgentOptions& options,
+    std::vector<AgentPlan>& plans);
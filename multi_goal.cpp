@@ -0,0 +1,156 @@
+#include "multi_goal.h"
+
+#include <limits>
+#include <algorithm>
+
+namespace {
+
+int GoalDistance(int x1, int y1, int x2, int y2, int connectivity) {
+    if (connectivity == 4) return COST_STRAIGHT * (abs(x1 - x2) + abs(y1 - y2));
+    return OctileDistance(x1, y1, x2, y2);
+}
+
+} // namespace
+
+void GoalSet::Reset(int mapWidth, int mapHeight) {
+    width = mapWidth;
+    height = mapHeight;
+    bucketsX = (width + (1 << GOAL_BUCKET_SHIFT) - 1) >> GOAL_BUCKET_SHIFT;
+    bucketsY = (height + (1 << GOAL_BUCKET_SHIFT) - 1) >> GOAL_BUCKET_SHIFT;
+    bits.assign((static_cast<size_t>(width) * height + 63) / 64, 0);
+    cells.clear();
+    buckets.assign(static_cast<size_t>(bucketsX) * bucketsY, std::vector<int>());
+    minBucketX = bucketsX;
+    minBucketY = bucketsY;
+    maxBucketX = -1;
+    maxBucketY = -1;
+}
+
+bool GoalSet::Add(int x, int y) {
+    if (x < 0 || x >= width || y < 0 || y >= height) return false;
+    const int cell = y * width + x;
+    if (Contains(cell)) return true;
+    bits[cell >> 6] |= 1ull << (cell & 63);
+    cells.push_back(cell);
+    const int bx = x >> GOAL_BUCKET_SHIFT;
+    const int by = y >> GOAL_BUCKET_SHIFT;
+    buckets[by * bucketsX + bx].push_back(cell);
+    minBucketX = std::min(minBucketX, bx);
+    minBucketY = std::min(minBucketY, by);
+    maxBucketX = std::max(maxBucketX, bx);
+    maxBucketY = std::max(maxBucketY, by);
+    return true;
+}
+
+int GoalSet::NearestDistance(int x, int y, int connectivity) const {
+    int best = std::numeric_limits<int>::max();
+    if (cells.size() <= GOAL_INDEX_THRESHOLD) {
+        for (size_t i = 0; i < cells.size(); i++) {
+            best = std::min(best, GoalDistance(x, y, cells[i] % width, cells[i] / width, connectivity));
+        }
+        return best;
+    }
+
+    auto scanBucket = [&](int bx, int by) {
+        const std::vector<int>& bucket = buckets[by * bucketsX + bx];
+        for (size_t i = 0; i < bucket.size(); i++) {
+            best = std::min(best, GoalDistance(x, y, bucket[i] % width, bucket[i] / width, connectivity));
+        }
+    };
+
+    // rȦͰڵĸ(x, y)ĳһ(r - 1) * Ͱ߳ + 1
+    // ֻɨյΧཻĲ֣Χ֮Ȧֱ
+    const int bx = x >> GOAL_BUCKET_SHIFT;
+    const int by = y >> GOAL_BUCKET_SHIFT;
+    const int firstRing = std::max(std::max(minBucketX - bx, bx - maxBucketX), std::max(minBucketY - by, by - maxBucketY));
+    const int lastRing = std::max(std::max(bx - minBucketX, maxBucketX - bx), std::max(by - minBucketY, maxBucketY - by));
+    for (int ring = std::max(firstRing, 0); ring <= lastRing; ring++) {
+        if (ring > 0 && best <= COST_STRAIGHT * (((ring - 1) << GOAL_BUCKET_SHIFT) + 1)) break;
+        const int left = bx - ring, right = bx + ring, top = by - ring, bottom = by + ring;
+        for (int cx = std::max(left, minBucketX); cx <= std::min(right, maxBucketX); cx++) {
+            if (top >= minBucketY) scanBucket(cx, top);
+            if (bottom <= maxBucketY && ring > 0) scanBucket(cx, bottom);
+        }
+        for (int cy = std::max(top + 1, minBucketY); cy <= std::min(bottom - 1, maxBucketY); cy++) {
+            if (left >= minBucketX) scanBucket(left, cy);
+            if (right <= maxBucketX && ring > 0) scanBucket(right, cy);
+        }
+    }
+    return best;
+}
+
+bool RunMultiGoalSearch(const PaddedGrid& grid, int startX, int startY, const GoalSet& goals,
+    const SearchOptions& options, SearchWorkspace& ws, SearchResult& result, int& reachedGoal) {
+    result.found = false;
+    result.cost = 0;
+    result.path.clear();
+    result.expanded = 0;
+    reachedGoal = -1;
+
+    if (goals.Width() != grid.width || goals.Height() != grid.height || goals.Count() == 0) return false;
+    if (startX < 0 || startX >= grid.width || startY < 0 || startY >= grid.height) return false;
+    const int start = grid.ToPadded(startX, startY);
+    if (grid.walls[start]) return false;
+
+    const int connectivity = options.connectivity == 4 ? 4 : 8;
+    const unsigned char* walls = grid.walls.data();
+    int offsets[8];
+    for (int d = 0; d < 8; d++) offsets[d] = SEARCH_DIRECTIONS[d][1] * grid.stride + SEARCH_DIRECTIONS[d][0];
+
+    ws.Begin(grid.CellCount());
+    std::vector<GridOpenEntry<int> >& openSet = ws.OpenStorage<int>();
+    openSet.clear();
+    ws.Open(start, 0, -1);
+    openSet.push_back({ goals.NearestDistance(startX, startY, connectivity), 0, start });
+    SEARCH_PROFILE_PUSH(ws, startX, startY);
+
+    int found = -1;
+    while (!openSet.empty()) {
+        std::pop_heap(openSet.begin(), openSet.end());
+        const GridOpenEntry<int> top = openSet.back();
+        openSet.pop_back();
+
+        const int current = top.cell;
+        if (ws.IsClosed(current)) continue;
+        ws.Close(current);
+        result.expanded++;
+        SEARCH_PROFILE_EXPAND(ws, grid.PaddedX(current), grid.PaddedY(current));
+
+        if (goals.Contains(grid.ToMapIndex(current))) {
+            found = current;
+            break;
+        }
+
+        const int currentG = ws.g[current];
+        for (int d = 0; d < connectivity; d++) {
+            const int next = current + offsets[d];
+            if (walls[next] || ws.IsClosed(next)) continue;
+            if (d >= 4) {
+                const bool wallX = walls[current + SEARCH_DIRECTIONS[d][0]] != 0;
+                const bool wallY = walls[current + SEARCH_DIRECTIONS[d][1] * grid.stride] != 0;
+                if (options.cornerRule == CORNER_BLOCK_BOTH ? (wallX && wallY) : (wallX || wallY)) continue;
+            }
+
+            const int newG = currentG + MoveCost(d);
+            if (newG >= ws.G(next)) continue;
+            ws.Open(next, newG, current);
+            const int nextX = grid.PaddedX(next), nextY = grid.PaddedY(next);
+            openSet.push_back({ newG + goals.NearestDistance(nextX, nextY, connectivity), newG, next });
+            std::push_heap(openSet.begin(), openSet.end());
+            SEARCH_PROFILE_PUSH(ws, nextX, nextY);
+        }
+    }
+
+    if (found < 0) return false;
+
+    for (int p = found; p != -1; p = ws.Parent(p)) {
+        result.path.push_back(grid.ToMapIndex(p));
+        if (p == start) break;
+    }
+    std::reverse(result.path.begin(), result.path.end());
+
+    result.found = true;
+    result.cost = ws.G(found);
+    reachedGoal = grid.ToMapIndex(found);
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "grid_map.h"
+#include "search_kernel.h"
+
+#include <vector>
+#include <cstdint>
+
+// յһA*յ㼰·һյ㼴
+// ÿյһΡֵȡյСֵȻɲһ£
+// յ϶ʱ8x8ͰռɽԶȦңȦ½ѲСڵǰСֵֹͣ
+
+const int GOAL_BUCKET_SHIFT = 3;            // Ͱ߳ = 1 << GOAL_BUCKET_SHIFT
+const size_t GOAL_INDEX_THRESHOLD = 16;     // յֵʱʹÿռ
+
+// յ㼯ϣӵλͼжǷΪյ㣬аͰֵյб
+class GoalSet {
+public:
+    GoalSet() : width(0), height(0), bucketsX(0), bucketsY(0), minBucketX(0), minBucketY(0), maxBucketX(-1), maxBucketY(-1) {}
+
+    void Reset(int mapWidth, int mapHeight);
+    // Խʱfalseظյ㱻
+    bool Add(int x, int y);
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+    size_t Count() const { return cells.size(); }
+    bool Contains(int cell) const { return ((bits[cell >> 6] >> (cell & 63)) & 1) != 0; }
+    const std::vector<int>& Cells() const { return cells; }
+
+    // (x, y)յֱ10/Խ14루4ʱΪپ10ûյʱINT_MAX
+    int NearestDistance(int x, int y, int connectivity) const;
+
+private:
+    int width, height;
+    int bucketsX, bucketsY;
+    int minBucketX, minBucketY, maxBucketX, maxBucketY;     // ǿͰİΧ
+    std::vector<uint64_t> bits;                 // λͼ
+    std::vector<int> cells;                     // ˳
+    std::vector<std::vector<int> > buckets;     // ÿͰڵյ
+};
+
+// ڴ߿ͼϴgoalsһɹʱreachedGoalΪյ㣨ԭʼͼ
+// result.pathβgoalsĳߴͼһ
+bool RunMultiGoalSearch(const PaddedGrid& grid, int startX, int startY, const GoalSet& goals,
+    const SearchOptions& options, SearchWorkspace& workspace, SearchResult& result, int& reachedGoal);
@@ -0,0 +1,370 @@
+#include "parallel_search.h"
+
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+// ӹ̵߳ĺѡڵ
+struct NodeMessage {
+    int cell;
+    int g;
+    int parent;
+};
+
+struct MessageBatch {
+    MessageBatch* next = nullptr;
+    std::vector<NodeMessage> items;
+};
+
+// ߵ߶УCASѹͷһȡȫ
+// 彻ͷABA
+class alignas(64) BatchQueue {
+public:
+    BatchQueue() : head(nullptr) {}
+
+    void Push(MessageBatch* batch) {
+        batch->next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(batch->next, batch, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    MessageBatch* TakeAll() {
+        if (head.load(std::memory_order_relaxed) == nullptr) return nullptr;
+        return head.exchange(nullptr, std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<MessageBatch*> head;
+};
+
+// ̹߳ĿбСfֵռһ
+struct alignas(64) FrontierSlot {
+    std::atomic<int> f;
+    FrontierSlot() : f(std::numeric_limits<int>::max()) {}
+};
+
+// ̹߳
+struct SharedSearch {
+    const PaddedGrid* grid;
+    SearchWorkspace* workspace;
+    int goal;
+    int goalX, goalY;           // ߿
+    int threadCount;
+    int batchSize;
+    int frontierWindow;
+    int blocksPerRow;
+
+    std::vector<BatchQueue> inboxes;
+    std::vector<FrontierSlot> frontiers;
+    alignas(64) std::atomic<long long> outstanding;     // Ծ߳ + ;ϢΪ0ʱ
+    alignas(64) std::atomic<int> incumbent;             // Ŀǰҵ·
+
+    // 16x4Ŀͬһ̣߳󲿷ھڱ̣߳gֵĻҲᱻ߳д
+    int Owner(int cell) const {
+        const int x = cell & (grid->stride - 1);
+        const int y = cell >> grid->shift;
+        uint32_t block = static_cast<uint32_t>((y >> 2) * blocksPerRow + (x >> 4));
+        block *= 0x9E3779B1u;
+        block ^= block >> 16;
+        return static_cast<int>((static_cast<uint64_t>(block) * threadCount) >> 32);
+    }
+};
+
+template<int Connectivity, CornerRule Rule>
+class HashWorker {
+    struct OpenEntry {
+        int f;
+        int g;
+        int cell;
+    };
+
+    // ڶѲfСȣfͬʱg
+    struct OpenCompare {
+        bool operator()(const OpenEntry& a, const OpenEntry& b) const {
+            return a.f > b.f || (a.f == b.f && a.g < b.g);
+        }
+    };
+
+    // ÿôڵһռ䲢δ
+    static const int EXPAND_CHUNK = 64;
+
+public:
+    HashWorker(SharedSearch& shared, int id)
+        : shared(shared), id(id), frontierWindow(shared.threadCount > 1 ? shared.frontierWindow : -1),
+        active(false), expanded(0), outgoing(shared.threadCount, nullptr) {
+        const int stride = shared.grid->stride;
+        for (int d = 0; d < 8; d++) offsets[d] = SEARCH_DIRECTIONS[d][1] * stride + SEARCH_DIRECTIONS[d][0];
+    }
+
+    ~HashWorker() {
+        for (size_t i = 0; i < outgoing.size(); i++) delete outgoing[i];
+        for (size_t i = 0; i < freeBatches.size(); i++) delete freeBatches[i];
+    }
+
+    // ɹ߳ǰ뿪бΪһԾ߳
+    void Seed(int cell) {
+        Push(cell, 0);
+        active = true;
+    }
+
+    size_t Expanded() const { return expanded; }
+
+    void Run() {
+        while (true) {
+            ReceiveAll();
+
+            // ԼСfȫСf̫ʱȲչֻϢչõĽڵ
+            if (!open.empty() && frontierWindow >= 0) {
+                const int f = open.front().f;
+                shared.frontiers[id].f.store(f, std::memory_order_relaxed);
+                int lowest = f;
+                for (int i = 0; i < shared.threadCount; i++) {
+                    lowest = std::min(lowest, shared.frontiers[i].f.load(std::memory_order_relaxed));
+                }
+                if (f > lowest + frontierWindow) {
+                    FlushAll();
+                    std::this_thread::yield();
+                    continue;
+                }
+            }
+
+            int budget = EXPAND_CHUNK;
+            while (budget > 0 && !open.empty()) {
+                const OpenEntry top = open.front();
+                // ѶѾܸĽǰ·ʣµĽڵȫ
+                if (top.f >= shared.incumbent.load(std::memory_order_relaxed)) {
+                    open.clear();
+                    break;
+                }
+                std::pop_heap(open.begin(), open.end(), OpenCompare());
+                open.pop_back();
+                if (top.g != shared.workspace->g[top.cell]) continue;  // и̵gֵ
+
+                Expand(top.cell, top.g);
+                expanded++;
+                budget--;
+            }
+            FlushAll();
+
+            if (open.empty()) {
+                shared.frontiers[id].f.store(std::numeric_limits<int>::max(), std::memory_order_relaxed);
+                // ϢѾ֮ܰԼΪ
+                if (active) {
+                    active = false;
+                    shared.outstanding.fetch_sub(1, std::memory_order_acq_rel);
+                }
+                if (shared.outstanding.load(std::memory_order_acquire) == 0) break;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    static int Heuristic(int dx, int dy) {
+        if (dx < 0) dx = -dx;
+        if (dy < 0) dy = -dy;
+        if (Connectivity == 4) return COST_STRAIGHT * (dx + dy);
+        return dx > dy ? COST_STRAIGHT * dx + (COST_DIAGONAL - COST_STRAIGHT) * dy
+            : COST_STRAIGHT * dy + (COST_DIAGONAL - COST_STRAIGHT) * dx;
+    }
+
+    int H(int cell) const {
+        return Heuristic((cell & (shared.grid->stride - 1)) - shared.goalX, (cell >> shared.grid->shift) - shared.goalY);
+    }
+
+    void Push(int cell, int g) {
+        open.push_back({ g + H(cell), g, cell });
+        std::push_heap(open.begin(), open.end(), OpenCompare());
+    }
+
+    // ̸߳յ̵gֵ²뿪бյʱŴ
+    void Improve(int cell, int g, int parent) {
+        SearchWorkspace& ws = *shared.workspace;
+        if (g >= ws.G(cell)) return;
+        ws.Open(cell, g, parent);
+
+        if (cell == shared.goal) {
+            int best = shared.incumbent.load(std::memory_order_relaxed);
+            while (g < best && !shared.incumbent.compare_exchange_weak(best, g, std::memory_order_relaxed)) {
+            }
+            return;
+        }
+        if (g + H(cell) < shared.incumbent.load(std::memory_order_relaxed)) Push(cell, g);
+    }
+
+    void Expand(int cell, int g) {
+        const unsigned char* walls = shared.grid->walls.data();
+        const int stride = shared.grid->stride;
+        const int incumbent = shared.incumbent.load(std::memory_order_relaxed);
+
+        for (int d = 0; d < Connectivity; d++) {
+            const int next = cell + offsets[d];
+            if (walls[next]) continue;
+            if (d >= 4) {
+                const bool wallX = walls[cell + SEARCH_DIRECTIONS[d][0]] != 0;
+                const bool wallY = walls[cell + SEARCH_DIRECTIONS[d][1] * stride] != 0;
+                if (Rule == CORNER_BLOCK_BOTH ? (wallX && wallY) : (wallX || wallY)) continue;
+            }
+
+            const int newG = g + (d < 4 ? COST_STRAIGHT : COST_DIAGONAL);
+            if (newG + H(next) >= incumbent) continue;
+
+            const int owner = shared.Owner(next);
+            if (owner == id) Improve(next, newG, cell);
+            else Send(owner, { next, newG, cell });
+        }
+    }
+
+    void Send(int owner, const NodeMessage& message) {
+        MessageBatch*& batch = outgoing[owner];
+        if (batch == nullptr) {
+            if (freeBatches.empty()) {
+                batch = new MessageBatch();
+                batch->items.reserve(shared.batchSize);
+            }
+            else {
+                batch = freeBatches.back();
+                freeBatches.pop_back();
+            }
+        }
+        batch->items.push_back(message);
+        if (static_cast<int>(batch->items.size()) >= shared.batchSize) Flush(owner);
+    }
+
+    // ȼӣ֤Ϣڱ֮ǰ
+    void Flush(int owner) {
+        MessageBatch* batch = outgoing[owner];
+        if (batch == nullptr) return;
+        outgoing[owner] = nullptr;
+        shared.outstanding.fetch_add(1, std::memory_order_acq_rel);
+        shared.inboxes[owner].Push(batch);
+    }
+
+    void FlushAll() {
+        for (int owner = 0; owner < shared.threadCount; owner++) Flush(owner);
+    }
+
+    // յڵкɿתΪԾȼΪԾٰѸӼмȥ
+    void ReceiveAll() {
+        MessageBatch* batch = shared.inboxes[id].TakeAll();
+        while (batch != nullptr) {
+            MessageBatch* next = batch->next;
+            for (size_t i = 0; i < batch->items.size(); i++) {
+                const NodeMessage& message = batch->items[i];
+                Improve(message.cell, message.g, message.parent);
+            }
+            if (!active && !open.empty()) {
+                active = true;
+                shared.outstanding.fetch_add(1, std::memory_order_acq_rel);
+            }
+            shared.outstanding.fetch_sub(1, std::memory_order_acq_rel);
+
+            batch->items.clear();
+            freeBatches.push_back(batch);
+            batch = next;
+        }
+    }
+
+    SharedSearch& shared;
+    const int id;
+    const int frontierWindow;   // ʾ
+    bool active;
+    size_t expanded;
+    int offsets[8];
+    std::vector<OpenEntry> open;                // 
+    std::vector<MessageBatch*> outgoing;        // ̡߳δ
+    std::vector<MessageBatch*> freeBatches;     // Լʱ
+};
+
+template<int Connectivity, CornerRule Rule>
+size_t RunWorkers(SharedSearch& shared, int start) {
+    std::vector<std::unique_ptr<HashWorker<Connectivity, Rule> > > workers;
+    for (int i = 0; i < shared.threadCount; i++) {
+        workers.emplace_back(new HashWorker<Connectivity, Rule>(shared, i));
+    }
+    workers[shared.Owner(start)]->Seed(start);
+
+    // ǰ߳Ϊ0Ź߳
+    std::vector<std::thread> threads;
+    for (int i = 1; i < shared.threadCount; i++) {
+        threads.emplace_back(&HashWorker<Connectivity, Rule>::Run, workers[i].get());
+    }
+    workers[0]->Run();
+    for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+    size_t expanded = 0;
+    for (size_t i = 0; i < workers.size(); i++) expanded += workers[i]->Expanded();
+    return expanded;
+}
+
+} // namespace
+
+bool RunParallelSearch(const PaddedGrid& grid, int startX, int startY, int goalX, int goalY,
+    const ParallelSearchOptions& options, SearchWorkspace& workspace, SearchResult& result) {
+    result.found = false;
+    result.cost = 0;
+    result.path.clear();
+    result.expanded = 0;
+
+    if (startX < 0 || startX >= grid.width || startY < 0 || startY >= grid.height ||
+        goalX < 0 || goalX >= grid.width || goalY < 0 || goalY >= grid.height) {
+        return false;
+    }
+
+    const int start = grid.ToPadded(startX, startY);
+    const int goal = grid.ToPadded(goalX, goalY);
+    if (grid.walls[start] || grid.walls[goal]) return false;
+
+    int threadCount = options.threadCount > 0 ? options.threadCount
+        : static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = std::min(std::max(threadCount, 1), 256);
+
+    SharedSearch shared;
+    shared.grid = &grid;
+    shared.workspace = &workspace;
+    shared.goal = goal;
+    shared.goalX = goal & (grid.stride - 1);
+    shared.goalY = goal >> grid.shift;
+    shared.threadCount = threadCount;
+    shared.batchSize = std::max(options.batchSize, 1);
+    shared.blocksPerRow = (grid.stride + 15) >> 4;
+    shared.frontierWindow = options.frontierWindow;
+    shared.inboxes = std::vector<BatchQueue>(threadCount);
+    shared.frontiers = std::vector<FrontierSlot>(threadCount);
+    shared.outstanding = 1;     // Ĺ߳
+    shared.incumbent = start == goal ? 0 : std::numeric_limits<int>::max();
+
+    workspace.Begin(grid.CellCount());
+    workspace.Open(start, 0, -1);
+
+    if (start != goal) {
+        if (options.search.connectivity == 4) {
+            result.expanded = RunWorkers<4, CORNER_BLOCK_BOTH>(shared, start);
+        }
+        else if (options.search.cornerRule == CORNER_BLOCK_BOTH) {
+            result.expanded = RunWorkers<8, CORNER_BLOCK_BOTH>(shared, start);
+        }
+        else {
+            result.expanded = RunWorkers<8, CORNER_BLOCK_ANY>(shared, start);
+        }
+    }
+
+    if (shared.incumbent.load() == std::numeric_limits<int>::max()) return false;
+
+    // ڵgֵֻСظڵݵĴ۲յgֵҲɻ
+    for (int p = goal; p != -1; p = workspace.Parent(p)) {
+        result.path.push_back(grid.ToMapIndex(p));
+        if (p == start) break;
+    }
+    std::reverse(result.path.begin(), result.path.end());
+
+    result.found = true;
+    result.cost = workspace.G(goal);
+    return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "search_kernel.h"
+
+// ѯĲA*ϣֲʽA*HDA*
+// Ӱ16x4Ŀϣָ̣߳ÿֻ߳άԼӵgֵڵͿб
+// ɵھ̣߳ܳһͨߵ߶зԷ
+// ߳չ˳ȫְf򣬸ӿܱ´򿪣ҵյ
+// յΪǰϽ磬fСϽĽڵֱӼ
+// ̶߳ûпչĽڵ㡢Ҳû;ϢʱʱϽ缴Ŵۡ
+// ̹߳ԼбСf̫߳ݻչٶչĽڵ㡣
+// ֹʹһԭӼԾбǿգ߳ + ѷδϢ
+
+struct ParallelSearchOptions {
+    SearchOptions search;
+    int threadCount = 0;        // ߳0ʾʹӲ߳
+    int batchSize = 128;        // ÿϢ
+    // ̵߳Сf߳СfеСֵôʱͣչʾƣ
+    // Ϊ0ʱֻСfС߳չ̶߳ڵȴĬϷſΪԽƶĴ
+    int frontierWindow = 3 * COST_DIAGONAL;
+};
+
+// ڴ߿ͼϲRunGridSearchһ··ܲͬ
+// result.expandedΪ߳չ֮ͣ´򿪵ĸӣ
+// workspacegֵ븸ڵ㱻̰߳ӹֱд룬ѯ֮Ը
+bool RunParallelSearch(const PaddedGrid& grid, int startX, int startY, int goalX, int goalY,
+    const ParallelSearchOptions& options, SearchWorkspace& workspace, SearchResult& result);
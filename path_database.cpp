@@ -0,0 +1,442 @@
+#include "path_database.h"
+#include "map_file.h"
+
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// ֻڴӳļ
+class MappedFile {
+public:
+    MappedFile() : data(nullptr), size(0) {}
+    ~MappedFile() { Close(); }
+
+    bool Open(const std::string& file) {
+        Close();
+#ifdef _WIN32
+        HANDLE handle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, NULL);
+        if (handle == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER fileSize;
+        HANDLE mapping = NULL;
+        if (GetFileSizeEx(handle, &fileSize) && fileSize.QuadPart > 0) {
+            mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        }
+        if (mapping) {
+            data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            size = static_cast<size_t>(fileSize.QuadPart);
+            CloseHandle(mapping);
+        }
+        CloseHandle(handle);
+#else
+        int handle = open(file.c_str(), O_RDONLY);
+        if (handle < 0) return false;
+
+        struct stat info;
+        if (fstat(handle, &info) == 0 && info.st_size > 0) {
+            void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, handle, 0);
+            if (view != MAP_FAILED) {
+                data = static_cast<const unsigned char*>(view);
+                size = static_cast<size_t>(info.st_size);
+            }
+        }
+        close(handle);
+#endif
+        if (!data) size = 0;
+        return data != nullptr;
+    }
+
+    void Close() {
+        if (!data) return;
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+#else
+        munmap(const_cast<unsigned char*>(data), size);
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    const unsigned char* Data() const { return data; }
+    size_t Size() const { return size; }
+
+private:
+    const unsigned char* data;
+    size_t size;
+};
+
+namespace {
+
+// ֮뵽8ֽڣʹoffsetsӳͼж
+size_t CellTablesBytes(size_t cellCount) {
+    return (2 * cellCount * sizeof(uint32_t) + 7) & ~static_cast<size_t>(7);
+}
+
+// ÿĺϷƶdλʾd
+void ComputeMoveMasks(const GridMap& map, std::vector<unsigned char>& masks) {
+    masks.assign(map.CellCount(), 0);
+    for (int y = 0; y < map.height; y++) {
+        for (int x = 0; x < map.width; x++) {
+            if (map.IsWall(x, y)) continue;
+            unsigned char mask = 0;
+            for (int d = 0; d < 8; d++) {
+                if (CanMove(map, x, y, d)) mask |= static_cast<unsigned char>(1 << d);
+            }
+            masks[map.Index(x, y)] = mask;
+        }
+    }
+}
+
+// ͨţƶԳƣԿɴＴͨͬʱȵ
+// ռڵյҲһɳ
+void LabelComponents(const GridMap& map, const std::vector<unsigned char>& masks,
+    std::vector<uint32_t>& components, std::vector<uint32_t>& ranks) {
+    const int cellCount = map.CellCount();
+    components.assign(cellCount, PATH_DB_NO_COMPONENT);
+    ranks.assign(cellCount, 0);
+    std::vector<int> stack;
+    uint32_t next = 0;
+    uint32_t rank = 0;
+
+    for (int seed = 0; seed < cellCount; seed++) {
+        if (map.walls[seed] || components[seed] != PATH_DB_NO_COMPONENT) continue;
+        stack.push_back(seed);
+        while (!stack.empty()) {
+            int cell = stack.back();
+            stack.pop_back();
+            if (components[cell] != PATH_DB_NO_COMPONENT) continue;
+            components[cell] = next;
+            ranks[cell] = rank++;
+
+            int x = cell % map.width, y = cell / map.width;
+            for (int d = 7; d >= 0; d--) {
+                if (!(masks[cell] & (1 << d))) continue;
+                int neighbor = map.Index(x + SEARCH_DIRECTIONS[d][0], y + SEARCH_DIRECTIONS[d][1]);
+                if (components[neighbor] == PATH_DB_NO_COMPONENT) stack.push_back(neighbor);
+            }
+        }
+        next++;
+    }
+
+    // ǽҪ𰸣
+    for (int cell = 0; cell < cellCount; cell++) {
+        if (map.walls[cell]) ranks[cell] = rank++;
+    }
+}
+
+// ̵߳ʱݣfirstMoveӵ
+struct FirstMoveScratch {
+    std::vector<int> dist;
+    std::vector<unsigned char> firstMove;
+    std::vector<int> buckets[COST_DIAGONAL + 1];
+};
+
+// sourceһDijkstra¼ÿӵ·һ
+// Ȩֻ1014ѭͰд
+void ComputeFirstMoves(const GridMap& map, const std::vector<unsigned char>& masks,
+    const std::vector<uint32_t>& ranks, int source, FirstMoveScratch& scratch) {
+    const int bucketCount = COST_DIAGONAL + 1;
+    int offsets[8];
+    for (int d = 0; d < 8; d++) offsets[d] = SEARCH_DIRECTIONS[d][1] * map.width + SEARCH_DIRECTIONS[d][0];
+
+    scratch.dist.assign(map.CellCount(), -1);
+    scratch.dist[source] = 0;
+    scratch.buckets[0].push_back(source);
+    size_t pending = 1;
+
+    for (int cost = 0; pending > 0; cost++) {
+        std::vector<int>& bucket = scratch.buckets[cost % bucketCount];
+        for (size_t i = 0; i < bucket.size(); i++) {
+            int cell = bucket[i];
+            pending--;
+            if (scratch.dist[cell] != cost) continue;
+
+            const unsigned char move = cell == source ? 0 : scratch.firstMove[ranks[cell]];
+            for (int d = 0; d < 8; d++) {
+                if (!(masks[cell] & (1 << d))) continue;
+                int neighbor = cell + offsets[d];
+                int newCost = cost + MoveCost(d);
+                if (scratch.dist[neighbor] >= 0 && scratch.dist[neighbor] <= newCost) continue;
+
+                scratch.dist[neighbor] = newCost;
+                scratch.firstMove[ranks[neighbor]] = cell == source ? static_cast<unsigned char>(d) : move;
+                scratch.buckets[newCost % bucketCount].push_back(neighbor);
+                pending++;
+            }
+        }
+        bucket.clear();
+    }
+}
+
+// sourceĵһյѹΪγ
+// ͬһĸյ㡢ǽsourceҪ𰸣ǰһ
+void CompressFirstMoves(const std::vector<uint32_t>& ranks, const std::vector<int>& componentCells,
+    int source, const FirstMoveScratch& scratch, std::vector<uint32_t>& runs) {
+    runs.clear();
+    int lastMove = -1;
+    for (size_t i = 0; i < componentCells.size(); i++) {
+        if (componentCells[i] == source) continue;
+        uint32_t rank = ranks[componentCells[i]];
+        int move = scratch.firstMove[rank];
+        if (move == lastMove) continue;
+        // һδ0ʼ֤κյ㶼ҵڵĶ
+        uint32_t start = runs.empty() ? 0 : rank;
+        runs.push_back((start << 3) | static_cast<uint32_t>(move));
+        lastMove = move;
+    }
+}
+
+} // namespace
+
+PathDatabase::PathDatabase() {
+    Reset();
+}
+
+PathDatabase::~PathDatabase() {
+}
+
+void PathDatabase::Reset() {
+    header = PathDatabaseHeader();
+    header.magic = PATH_DB_MAGIC;
+    header.headerSize = sizeof(PathDatabaseHeader);
+    components = nullptr;
+    ranks = nullptr;
+    offsets = nullptr;
+    runs = nullptr;
+    ownedComponents.clear();
+    ownedRanks.clear();
+    ownedOffsets.clear();
+    ownedRuns.clear();
+    mapped.reset();
+}
+
+bool PathDatabase::Build(const GridMap& map, int threadCount) {
+    Reset();
+    const int cellCount = map.CellCount();
+    // γ̵ʼռ29λ
+    if (cellCount <= 0 || cellCount >= (1 << 29)) return false;
+
+    std::vector<unsigned char> masks;
+    ComputeMoveMasks(map, masks);
+    LabelComponents(map, masks, ownedComponents, ownedRanks);
+
+    // ÿĸӰг
+    std::vector<int> byRank(cellCount);
+    for (int cell = 0; cell < cellCount; cell++) byRank[ownedRanks[cell]] = cell;
+    std::vector<int> componentStart;
+    for (int r = 0; r < cellCount && !map.walls[byRank[r]]; r++) {
+        if (r == 0 || ownedComponents[byRank[r]] != ownedComponents[byRank[r - 1]]) componentStart.push_back(r);
+    }
+    componentStart.push_back(static_cast<int>(std::count(map.walls.begin(), map.walls.end(), 0)));
+
+    if (threadCount <= 0) threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    threadCount = std::min(threadCount, cellCount);
+
+    // ̰߳ԭӼȡ㣬ȴ浽ÿԼ
+    std::vector<std::vector<uint32_t> > sourceRuns(cellCount);
+    std::atomic<int> nextSource(0);
+    auto worker = [&]() {
+        FirstMoveScratch scratch;
+        scratch.firstMove.assign(cellCount, 0);
+        std::vector<int> componentCells;
+        while (true) {
+            int source = nextSource.fetch_add(1);
+            if (source >= cellCount) break;
+            if (map.walls[source]) continue;
+
+            uint32_t component = ownedComponents[source];
+            componentCells.assign(byRank.begin() + componentStart[component], byRank.begin() + componentStart[component + 1]);
+            ComputeFirstMoves(map, masks, ownedRanks, source, scratch);
+            CompressFirstMoves(ownedRanks, componentCells, source, scratch, sourceRuns[source]);
+            sourceRuns[source].shrink_to_fit();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadCount; i++) threads.emplace_back(worker);
+    worker();
+    for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+    ownedOffsets.assign(cellCount + 1, 0);
+    for (int source = 0; source < cellCount; source++) {
+        ownedOffsets[source + 1] = ownedOffsets[source] + sourceRuns[source].size();
+    }
+    ownedRuns.reserve(static_cast<size_t>(ownedOffsets[cellCount]));
+    for (int source = 0; source < cellCount; source++) {
+        ownedRuns.insert(ownedRuns.end(), sourceRuns[source].begin(), sourceRuns[source].end());
+        std::vector<uint32_t>().swap(sourceRuns[source]);
+    }
+
+    header.width = map.width;
+    header.height = map.height;
+    header.wallHash = HashWalls(map);
+    header.runCount = ownedRuns.size();
+    components = ownedComponents.data();
+    ranks = ownedRanks.data();
+    offsets = ownedOffsets.data();
+    runs = ownedRuns.data();
+    return true;
+}
+
+bool PathDatabase::Save(const std::string& file) const {
+    if (!components) return false;
+    std::ofstream output(file.c_str(), std::ios::binary);
+    if (!output.is_open()) return false;
+
+    const size_t cellCount = static_cast<size_t>(header.width) * header.height;
+    const size_t tablesBytes = CellTablesBytes(cellCount);
+    const char padding[8] = { 0 };
+
+    // ְд˳Уֵ
+    const std::pair<const void*, size_t> parts[] = {
+        std::make_pair(static_cast<const void*>(components), cellCount * sizeof(uint32_t)),
+        std::make_pair(static_cast<const void*>(ranks), cellCount * sizeof(uint32_t)),
+        std::make_pair(static_cast<const void*>(padding), tablesBytes - 2 * cellCount * sizeof(uint32_t)),
+        std::make_pair(static_cast<const void*>(offsets), (cellCount + 1) * sizeof(uint64_t)),
+        std::make_pair(static_cast<const void*>(runs), static_cast<size_t>(header.runCount) * sizeof(uint32_t)) };
+    PathDatabaseHeader fileHeader = header;
+    fileHeader.dataHash = HashBytes(nullptr, 0);
+    for (const auto& part : parts) fileHeader.dataHash = HashBytes(part.first, part.second, fileHeader.dataHash);
+
+    output.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+    for (const auto& part : parts) output.write(static_cast<const char*>(part.first), part.second);
+    return static_cast<bool>(output);
+}
+
+bool PathDatabase::Open(const std::string& file, const GridMap& map) {
+    Reset();
+    std::unique_ptr<MappedFile> view(new MappedFile());
+    if (!view->Open(file) || view->Size() < sizeof(PathDatabaseHeader)) return false;
+
+    PathDatabaseHeader fileHeader;
+    std::copy(view->Data(), view->Data() + sizeof(fileHeader), reinterpret_cast<unsigned char*>(&fileHeader));
+    if (fileHeader.magic != PATH_DB_MAGIC || fileHeader.headerSize != sizeof(PathDatabaseHeader) ||
+        fileHeader.width != map.width || fileHeader.height != map.height || fileHeader.wallHash != HashWalls(map)) {
+        return false;
+    }
+
+    // ֳУֵضϻ𻵵ļԽȡ
+    const size_t cellCount = static_cast<size_t>(map.CellCount());
+    const size_t tablesBytes = CellTablesBytes(cellCount);
+    const size_t offsetsBytes = (cellCount + 1) * sizeof(uint64_t);
+    const size_t expected = sizeof(PathDatabaseHeader) + tablesBytes + offsetsBytes;
+    if (view->Size() < expected || (view->Size() - expected) % sizeof(uint32_t) != 0 ||
+        (view->Size() - expected) / sizeof(uint32_t) != fileHeader.runCount) {
+        return false;
+    }
+
+    const unsigned char* base = view->Data() + sizeof(PathDatabaseHeader);
+    if (HashBytes(base, view->Size() - sizeof(PathDatabaseHeader)) != fileHeader.dataHash) return false;
+    const uint64_t* fileOffsets = reinterpret_cast<const uint64_t*>(base + tablesBytes);
+    if (fileOffsets[0] != 0 || fileOffsets[cellCount] != fileHeader.runCount) return false;
+    for (size_t i = 0; i < cellCount; i++) {
+        if (fileOffsets[i] > fileOffsets[i + 1]) return false;
+    }
+
+    // еֵǽûзšոķյŶСڸŲظ
+    // ÿγ̰յŵУѯʱֲңʼСڸ
+    // ǽûγ̣γ̵ķǴĺϷƶѯʱط߳ĸһͬһĿո
+    const uint32_t* fileComponents = reinterpret_cast<const uint32_t*>(base);
+    const uint32_t* fileRanks = fileComponents + cellCount;
+    const uint32_t* fileRuns = reinterpret_cast<const uint32_t*>(base + tablesBytes + offsetsBytes);
+    std::vector<unsigned char> rankUsed(cellCount, 0);
+    for (size_t i = 0; i < cellCount; i++) {
+        if (map.walls[i]) {
+            if (fileComponents[i] != PATH_DB_NO_COMPONENT) return false;
+            continue;
+        }
+        if (fileComponents[i] >= cellCount || fileRanks[i] >= cellCount || rankUsed[fileRanks[i]]) return false;
+        rankUsed[fileRanks[i]] = 1;
+    }
+    for (size_t i = 0; i < cellCount; i++) {
+        if (map.walls[i] && fileOffsets[i] != fileOffsets[i + 1]) return false;
+        const int x = static_cast<int>(i % map.width), y = static_cast<int>(i / map.width);
+        for (uint64_t r = fileOffsets[i]; r < fileOffsets[i + 1]; r++) {
+            if ((fileRuns[r] >> 3) >= cellCount || !CanMove(map, x, y, static_cast<int>(fileRuns[r] & 7u))) return false;
+            if (r > fileOffsets[i] && (fileRuns[r] >> 3) <= (fileRuns[r - 1] >> 3)) return false;
+        }
+    }
+
+    header = fileHeader;
+    components = fileComponents;
+    ranks = fileRanks;
+    offsets = fileOffsets;
+    runs = fileRuns;
+    mapped = std::move(view);
+    return true;
+}
+
+bool PathDatabase::IsBuiltFor(const GridMap& map) const {
+    return components && header.width == map.width && header.height == map.height && header.wallHash == HashWalls(map);
+}
+
+int PathDatabase::FirstMove(int source, int target) const {
+    if (source == target || components[source] == PATH_DB_NO_COMPONENT ||
+        components[source] != components[target]) {
+        return -1;
+    }
+
+    // ҵʼŲtargetŵһ
+    const uint32_t* begin = runs + offsets[source];
+    const uint32_t* end = runs + offsets[source + 1];
+    const uint32_t key = (ranks[target] << 3) | 7u;
+    const uint32_t* found = std::upper_bound(begin, end, key);
+    if (found == begin) return -1;
+    return static_cast<int>(found[-1] & 7u);
+}
+
+bool PathDatabase::FindPath(int startX, int startY, int goalX, int goalY, SearchResult& result) const {
+    result.found = false;
+    result.cost = 0;
+    result.path.clear();
+    result.expanded = 0;
+
+    const int width = header.width, height = header.height;
+    if (!components || startX < 0 || startX >= width || startY < 0 || startY >= height ||
+        goalX < 0 || goalX >= width || goalY < 0 || goalY >= height) {
+        return false;
+    }
+
+    const int start = startY * width + startX;
+    const int goal = goalY * width + goalX;
+    if (components[start] == PATH_DB_NO_COMPONENT || components[start] != components[goal]) return false;
+
+    // ÿһĳ·ĵһǰʣϸС˱Ȼյ㣻
+    // ֻڷ𻵵
+    int x = startX, y = startY;
+    result.path.push_back(start);
+    for (int steps = 0; x != goalX || y != goalY; steps++) {
+        int move = FirstMove(y * width + x, goal);
+        result.expanded++;
+        if (move < 0 || steps >= width * height) {
+            result.path.clear();
+            return false;
+        }
+        x += SEARCH_DIRECTIONS[move][0];
+        y += SEARCH_DIRECTIONS[move][1];
+        // еķ򲻻߳ڷ𻵵
+        if (x < 0 || x >= width || y < 0 || y >= height || components[y * width + x] != components[goal]) {
+            result.path.clear();
+            return false;
+        }
+        result.cost += MoveCost(move);
+        result.path.push_back(y * width + x);
+    }
+
+    result.found = true;
+    return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "grid_map.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// ѹ·ݿ⣨Compressed Path Database
+// ÿӼ¼ͨյ·һSEARCH_DIRECTIONS±꣬3λ
+// յ㰴кγѹÿΪ (ʼյ << 3) | 
+// ǽ벻ͨյ㲻Ҫ𰸣ǰһΣͨ÷ŵжϡ
+// ѯʱ㿪ʼһֱյ㣬迪б
+// ֻ֧8CORNER_BLOCK_BOTH
+//
+// ļʽֱڴӳʹãͷ֮ȫݼ¼Уֵʱ飩
+//   PathDatabaseHeader
+//   uint32 components[cellCount]       ţǽΪPATH_DB_NO_COMPONENT
+//   uint32 ranks[cellCount]            Ϊյʱ
+//   뵽8ֽڣ
+//   uint64 offsets[cellCount + 1]      ÿγrunsеķΧ
+//   uint32 runs[runCount]
+
+const uint32_t PATH_DB_MAGIC = 0x32445043;         // "CPD2"
+const uint32_t PATH_DB_NO_COMPONENT = 0xFFFFFFFFu;
+
+struct PathDatabaseHeader {
+    uint32_t magic;
+    uint32_t headerSize;
+    int32_t width;
+    int32_t height;
+    uint32_t wallHash;
+    uint32_t dataHash;      // ͷ֮ȫݵFNV-1aУֵ
+    uint64_t runCount;
+};
+
+class MappedFile;
+
+class PathDatabase {
+public:
+    PathDatabase();
+    ~PathDatabase();
+    PathDatabase(const PathDatabase&) = delete;
+    PathDatabase& operator=(const PathDatabase&) = delete;
+
+    // threadCount̹߳0ʾʹӲ߳ͼʱfalse
+    bool Build(const GridMap& map, int threadCount = 0);
+
+    // дļڴӳ䷽ʽļͼļһ»ļʱfalse
+    bool Save(const std::string& file) const;
+    bool Open(const std::string& file, const GridMap& map);
+
+    bool IsBuiltFor(const GridMap& map) const;
+
+    // sourcetargetĵһ·source == targetʱ-1
+    int FirstMove(int source, int target) const;
+
+    // 𲽲õ·result.expandedΪ
+    bool FindPath(int startX, int startY, int goalX, int goalY, SearchResult& result) const;
+
+    size_t RunCount() const { return static_cast<size_t>(header.runCount); }
+
+private:
+    void Reset();
+
+    PathDatabaseHeader header;
+    const uint32_t* components;
+    const uint32_t* ranks;
+    const uint64_t* offsets;
+    const uint32_t* runs;
+
+    // õݱļʱλӳͼ
+    std::vector<uint32_t> ownedComponents;
+    std::vector<uint32_t> ownedRanks;
+    std::vector<uint64_t> ownedOffsets;
+    std::vector<uint32_t> ownedRuns;
+    std::unique_ptr<MappedFile> mapped;
+};
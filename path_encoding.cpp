@@ -0,0 +1,71 @@
+#include "path_encoding.h"
+
+namespace {
+
+// ֮ķ±꣬ʱ-1
+int StepDirection(int from, int to, int mapWidth) {
+    const int dx = to % mapWidth - from % mapWidth;
+    const int dy = to / mapWidth - from / mapWidth;
+    for (int d = 0; d < 8; d++) {
+        if (SEARCH_DIRECTIONS[d][0] == dx && SEARCH_DIRECTIONS[d][1] == dy) return d;
+    }
+    return -1;
+}
+
+} // namespace
+
+size_t EncodeDirectionRuns(const int* path, size_t count, int mapWidth, unsigned char* runs, size_t capacity) {
+    size_t written = 0;
+    size_t i = 1;
+    while (i < count) {
+        const int dir = StepDirection(path[i - 1], path[i], mapWidth);
+        if (dir < 0) return PATH_RUNS_INVALID;
+        int length = 1;
+        while (i + length < count && length < PATH_RUN_MAX &&
+            StepDirection(path[i + length - 1], path[i + length], mapWidth) == dir) {
+            length++;
+        }
+        if (written < capacity) runs[written] = static_cast<unsigned char>((dir << 5) | (length - 1));
+        written++;
+        i += length;
+    }
+    return written;
+}
+
+size_t DecodeDirectionRuns(const unsigned char* runs, size_t count, int startCell, int mapWidth, int* path, size_t capacity) {
+    size_t written = 0;
+    int cell = startCell;
+    if (written < capacity) path[written] = cell;
+    written++;
+    for (size_t i = 0; i < count; i++) {
+        const int dir = runs[i] >> 5;
+        const int length = (runs[i] & 31) + 1;
+        const int offset = SEARCH_DIRECTIONS[dir][1] * mapWidth + SEARCH_DIRECTIONS[dir][0];
+        for (int step = 0; step < length; step++) {
+            cell += offset;
+            if (written < capacity) path[written] = cell;
+            written++;
+        }
+    }
+    return written;
+}
+
+size_t CollapseWaypoints(const int* path, size_t count, int mapWidth, int* waypoints, size_t capacity) {
+    if (count == 0) return 0;
+    // ȶдλʼղдλã˿ԭѹ
+    size_t written = 0;
+    int previousDir = -1;
+    int previousCell = path[0];
+    for (size_t i = 1; i < count; i++) {
+        const int dir = StepDirection(previousCell, path[i], mapWidth);
+        if (dir != previousDir) {
+            if (written < capacity) waypoints[written] = previousCell;
+            written++;
+            previousDir = dir;
+        }
+        previousCell = path[i];
+    }
+    if (written < capacity) waypoints[written] = previousCell;
+    written++;
+    return written;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "grid_map.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// ·Ľд÷ṩĻڲڴ
+//   γ  ÿֽڸ3λΪSEARCH_DIRECTIONS±꣩5λΪ1
+//             PATH_RUN_MAXֱ߶βɶֽڣɵ÷и
+//   յ      ֻ㡢յͷı䴦ĸӣڹյֱ֮߻45б
+// кĳȣʱֻдǰcapacityԪأ÷
+
+const int PATH_RUN_MAX = 32;
+// ·8һʱEncodeDirectionRunsķֵ
+const size_t PATH_RUNS_INVALID = SIZE_MAX;
+
+// pathΪԭʼͼy * width + x8һ򷵻PATH_RUNS_INVALID
+size_t EncodeDirectionRuns(const int* path, size_t count, int mapWidth, unsigned char* runs, size_t capacity);
+
+// 㰴γ̻ԭ
+size_t DecodeDirectionRuns(const unsigned char* runs, size_t count, int startCell, int mapWidth, int* path, size_t capacity);
+
+// waypointspathͬԭѹ
+size_t CollapseWaypoints(const int* path, size_t count, int mapWidth, int* waypoints, size_t capacity);
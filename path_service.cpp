@@ -0,0 +1,1237 @@
+#include "path_service.h"
+#include "search_kernel.h"
+#include "ara_star.h"
+#include "subgoal_graph.h"
+#include "rectangle_graph.h"
+#include "map_file.h"
+#include "path_database.h"
+#include "jps_plus.h"
+#include "map_edit.h"
+#include "parallel_search.h"
+#include "distance_field.h"
+#include "multi_agent.h"
+#include "multi_goal.h"
+#include "path_encoding.h"
+#include "search_profiler.h"
+
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+long long MicrosBetween(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+// ---------------------------------------------------------------------------
+// СJSONֻ֧õĶ顢ַ֡Ͳֵ
+
+struct JsonValue {
+    enum Type { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+
+    Type type = JSON_NULL;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue> > members;
+
+    const JsonValue* Find(const char* key) const {
+        for (size_t i = 0; i < members.size(); i++) {
+            if (members[i].first == key) return &members[i].second;
+        }
+        return nullptr;
+    }
+
+    int AsInt(int fallback = 0) const {
+        return type == JSON_NUMBER ? static_cast<int>(number) : fallback;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& source) : text(source), pos(0) {}
+
+    bool Parse(JsonValue& value) {
+        if (!ParseValue(value)) return false;
+        SkipSpace();
+        return pos == text.size();
+    }
+
+private:
+    void SkipSpace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n')) pos++;
+    }
+
+    bool Match(const char* word) {
+        size_t length = strlen(word);
+        if (text.compare(pos, length, word) != 0) return false;
+        pos += length;
+        return true;
+    }
+
+    bool ParseString(std::string& out) {
+        if (text[pos] != '"') return false;
+        pos++;
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c == '\\' && pos < text.size()) {
+                char e = text[pos++];
+                switch (e) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u':
+                    // ֻASCIIΧڵתַ
+                    if (pos + 4 > text.size()) return false;
+                    out += static_cast<char>(strtol(text.substr(pos, 4).c_str(), nullptr, 16) & 0x7F);
+                    pos += 4;
+                    break;
+                default: out += e; break;
+                }
+            }
+            else {
+                out += c;
+            }
+        }
+        if (pos >= text.size()) return false;
+        pos++;
+        return true;
+    }
+
+    bool ParseValue(JsonValue& value) {
+        SkipSpace();
+        if (pos >= text.size()) return false;
+
+        char c = text[pos];
+        if (c == '{') {
+            value.type = JsonValue::JSON_OBJECT;
+            pos++;
+            SkipSpace();
+            if (pos < text.size() && text[pos] == '}') { pos++; return true; }
+            while (true) {
+                SkipSpace();
+                std::string key;
+                if (pos >= text.size() || !ParseString(key)) return false;
+                SkipSpace();
+                if (pos >= text.size() || text[pos] != ':') return false;
+                pos++;
+                value.members.push_back(std::make_pair(key, JsonValue()));
+                if (!ParseValue(value.members.back().second)) return false;
+                SkipSpace();
+                if (pos < text.size() && text[pos] == ',') { pos++; continue; }
+                if (pos < text.size() && text[pos] == '}') { pos++; return true; }
+                return false;
+            }
+        }
+        if (c == '[') {
+            value.type = JsonValue::JSON_ARRAY;
+            pos++;
+            SkipSpace();
+            if (pos < text.size() && text[pos] == ']') { pos++; return true; }
+            while (true) {
+                value.items.push_back(JsonValue());
+                if (!ParseValue(value.items.back())) return false;
+                SkipSpace();
+                if (pos < text.size() && text[pos] == ',') { pos++; continue; }
+                if (pos < text.size() && text[pos] == ']') { pos++; return true; }
+                return false;
+            }
+        }
+        if (c == '"') {
+            value.type = JsonValue::JSON_STRING;
+            return ParseString(value.text);
+        }
+        if (Match("true")) { value.type = JsonValue::JSON_BOOL; value.number = 1; return true; }
+        if (Match("false")) { value.type = JsonValue::JSON_BOOL; value.number = 0; return true; }
+        if (Match("null")) { value.type = JsonValue::JSON_NULL; return true; }
+
+        const char* begin = text.c_str() + pos;
+        char* end = nullptr;
+        value.number = strtod(begin, &end);
+        if (end == begin) return false;
+        value.type = JsonValue::JSON_NUMBER;
+        pos += end - begin;
+        return true;
+    }
+
+    const std::string& text;
+    size_t pos;
+};
+
+std::string JsonQuote(const std::string& value) {
+    std::string out = "\"";
+    for (size_t i = 0; i < value.size(); i++) {
+        char c = value[i];
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if (c == '\n') out += "\\n";
+        else if (static_cast<unsigned char>(c) < 0x20) out += ' ';
+        else out += c;
+    }
+    out += '"';
+    return out;
+}
+
+// idԭתΪJSONı
+std::string IdToJson(const JsonValue* id) {
+    if (!id) return "null";
+    if (id->type == JsonValue::JSON_STRING) return JsonQuote(id->text);
+    if (id->type == JsonValue::JSON_NUMBER) {
+        std::ostringstream out;
+        out << static_cast<long long>(id->number);
+        return out.str();
+    }
+    return "null";
+}
+
+// ---------------------------------------------------------------------------
+// ͼѯ
+
+// ԤĿͼԾվηֽ⣩ڵһʹʱͬһϵĲѯֻһ
+// ӵͼļһµõʱڷǰready
+template<typename T>
+struct PreprocessCache {
+    std::once_flag once;
+    std::atomic<bool> ready{ false };
+    T data;
+
+    const T& Get(const GridMap& map) {
+        std::call_once(once, [&] {
+            if (!ready) {
+                data.Build(map);
+                ready = true;
+            }
+        });
+        return data;
+    }
+};
+
+// ѽõԤԭջӰ
+template <typename T>
+std::shared_ptr<PreprocessCache<T> > CopyCache(const PreprocessCache<T>& cache) {
+    std::shared_ptr<PreprocessCache<T> > copy = std::make_shared<PreprocessCache<T> >();
+    if (cache.ready) {
+        copy->data = cache.data;
+        copy->ready = true;
+    }
+    return copy;
+}
+
+struct ServiceMap {
+    GridMap map;
+    PaddedGrid grid;
+    std::shared_ptr<PreprocessCache<SubgoalGraph> > subgoals = std::make_shared<PreprocessCache<SubgoalGraph> >();
+    std::shared_ptr<PreprocessCache<JumpTable> > jumpTable = std::make_shared<PreprocessCache<JumpTable> >();
+    std::shared_ptr<PreprocessCache<RectangleGraph> > rectangles = std::make_shared<PreprocessCache<RectangleGraph> >();
+    std::shared_ptr<const PathDatabase> pathDatabase;   // build_path_dbload_path_db
+};
+
+// ѯеͼգ޸ĵͼǰȵύĲѯִ꣬ղٱѯʱԭ޸ģ
+// ߣһ¿
+typedef std::shared_ptr<const ServiceMap> MapSnapshot;
+
+// һѯѯȫɺд
+struct PendingResponse {
+    std::string id;
+    bool isBatch = false;
+    std::vector<std::string> results;
+    std::atomic<size_t> remaining{ 0 };
+};
+
+enum QueryEngine {
+    QUERY_ENGINE_GRID,          // A*ֹʱʱΪARA*
+    QUERY_ENGINE_SUBGOAL,       // Ŀͼ
+    QUERY_ENGINE_JPS_PLUS,      // JPS+Ծ
+    QUERY_ENGINE_RECTANGLES,    // ζԳ
+    QUERY_ENGINE_PATH_DB,       // ѹ·ݿ
+    QUERY_ENGINE_PARALLEL       // ̲߳A*ڵѯ
+};
+
+enum PathOutput {
+    PATH_OUTPUT_CELLS,          // "path":[[x,y],...]
+    PATH_OUTPUT_WAYPOINTS,      // "waypoints":[[x,y],...]ֻı䴦
+    PATH_OUTPUT_RUNS            // "runs":"..."γֽڵbase64㿪ʼ
+};
+
+struct QueryTask {
+    MapSnapshot map;
+    int startX = 0, startY = 0, goalX = 0, goalY = 0;
+    SearchOptions search;
+    long long deadlineMicros = 0;
+    QueryEngine engine = QUERY_ENGINE_GRID;
+    int threads = 0;            // A*߳0ʾʹӲ߳
+    std::shared_ptr<const GoalSet> goals;   // ǿʱΪյѯgoalX/goalY
+    PathOutput pathFormat = PATH_OUTPUT_CELLS;
+    std::shared_ptr<SearchProfiler> profiler;   // õͼͳչȶʱǿ
+    Clock::time_point received;
+    std::shared_ptr<PendingResponse> response;
+    size_t slot = 0;
+};
+
+class ResponseWriter {
+public:
+    explicit ResponseWriter(std::ostream& stream) : output(stream) {}
+
+    void Write(const std::string& line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        output << line << '\n';
+        output.flush();
+    }
+
+private:
+    std::ostream& output;
+    std::mutex mutex;
+};
+
+std::string ErrorResponse(const std::string& id, const std::string& message) {
+    return "{\"id\":" + id + ",\"ok\":false,\"error\":" + JsonQuote(message) + "}";
+}
+
+// ÿ̸߳Գеʱ֮A*ѯٷڴ
+struct QueryWorkspaces {
+    SearchWorkspace search;
+    AnytimeWorkspace anytime;
+    SubgoalQueryWorkspace subgoal;
+    SearchResult result;
+    AnytimeResult anytimeResult;
+    std::vector<unsigned char> runs;
+    std::string text;
+    std::shared_ptr<SearchProfiler> profiler;   // ߳ѵǼǼǴͳ
+    ProfileCounters* profileCounters = nullptr;
+};
+
+void AppendInt(std::string& out, long long value) {
+    char buffer[24];
+    const int length = snprintf(buffer, sizeof(buffer), "%lld", value);
+    out.append(buffer, length);
+}
+
+void AppendPoint(std::string& out, int cell, int mapWidth) {
+    out += '[';
+    AppendInt(out, cell % mapWidth);
+    out += ',';
+    AppendInt(out, cell / mapWidth);
+    out += ']';
+}
+
+void AppendBase64(std::string& out, const unsigned char* data, size_t count) {
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (size_t i = 0; i < count; i += 3) {
+        const unsigned int chunk = (data[i] << 16) | (i + 1 < count ? data[i + 1] << 8 : 0) | (i + 2 < count ? data[i + 2] : 0);
+        out += ALPHABET[(chunk >> 18) & 63];
+        out += ALPHABET[(chunk >> 12) & 63];
+        out += i + 1 < count ? ALPHABET[(chunk >> 6) & 63] : '=';
+        out += i + 2 < count ? ALPHABET[chunk & 63] : '=';
+    }
+}
+
+// ִеѯѽֶΣid㻨ţ׷ӵout
+void ExecuteQuery(const QueryTask& task, QueryWorkspaces& workspaces, std::string& out) {
+    // ͳչȶʱȡ̵߳ļÿͳÿֻ߳ǼһΣÿ
+    ProfileCounters* counters = nullptr;
+    if (task.profiler) {
+        if (workspaces.profiler != task.profiler) {
+            workspaces.profiler = task.profiler;
+            workspaces.profileCounters = task.profiler->AddThread();
+        }
+        counters = workspaces.profileCounters;
+        counters->queries++;
+    }
+    else if (workspaces.profiler) {
+        workspaces.profiler.reset();
+        workspaces.profileCounters = nullptr;
+    }
+    workspaces.search.profile = counters;
+    workspaces.anytime.base.profile = counters;
+    workspaces.subgoal.search.profile = counters;
+
+    Clock::time_point begin = Clock::now();
+    const ServiceMap& serviceMap = *task.map;
+    const int width = serviceMap.map.width;
+
+    SearchResult* result = &workspaces.result;
+    int reachedGoal = -1;
+
+    if (task.goals) {
+        RunMultiGoalSearch(serviceMap.grid, task.startX, task.startY, *task.goals, task.search, workspaces.search, *result, reachedGoal);
+    }
+    else if (task.deadlineMicros > 0) {
+        AnytimeOptions options;
+        options.search = task.search;
+        options.deadlineMicros = task.deadlineMicros;
+        RunAnytimeSearch(serviceMap.grid, task.startX, task.startY, task.goalX, task.goalY, options, workspaces.anytime,
+            workspaces.anytimeResult);
+        result = &workspaces.anytimeResult;
+    }
+    else if (task.engine == QUERY_ENGINE_SUBGOAL) {
+        const SubgoalGraph& graph = serviceMap.subgoals->Get(serviceMap.map);
+        graph.FindPath(serviceMap.map, task.startX, task.startY, task.goalX, task.goalY, workspaces.subgoal, *result);
+    }
+    else if (task.engine == QUERY_ENGINE_JPS_PLUS) {
+        const JumpTable& table = serviceMap.jumpTable->Get(serviceMap.map);
+        table.FindPath(serviceMap.map, task.startX, task.startY, task.goalX, task.goalY, workspaces.search, *result);
+    }
+    else if (task.engine == QUERY_ENGINE_RECTANGLES) {
+        const RectangleGraph& graph = serviceMap.rectangles->Get(serviceMap.map);
+        graph.FindPath(serviceMap.map, task.startX, task.startY, task.goalX, task.goalY, workspaces.search, *result);
+    }
+    else if (task.engine == QUERY_ENGINE_PATH_DB) {
+        serviceMap.pathDatabase->FindPath(task.startX, task.startY, task.goalX, task.goalY, *result);
+    }
+    else if (task.engine == QUERY_ENGINE_PARALLEL) {
+        ParallelSearchOptions options;
+        options.search = task.search;
+        options.threadCount = task.threads;
+        RunParallelSearch(serviceMap.grid, task.startX, task.startY, task.goalX, task.goalY, options, workspaces.search, *result);
+    }
+    else {
+        RunGridSearch(serviceMap.grid, task.startX, task.startY, task.goalX, task.goalY, task.search, workspaces.search, *result);
+    }
+    Clock::time_point end = Clock::now();
+
+    out += result->found ? "\"ok\":true,\"found\":true" : "\"ok\":true,\"found\":false";
+    if (result->found) {
+        out += ",\"cost\":";
+        AppendInt(out, result->cost);
+    }
+    if (reachedGoal >= 0) {
+        out += ",\"goal\":";
+        AppendPoint(out, reachedGoal, width);
+    }
+    out += ",\"expanded\":";
+    AppendInt(out, static_cast<long long>(result->expanded));
+    // ֻARA*ĽϽǷ
+    if (result == &workspaces.anytimeResult && result->found) {
+        char bound[32];
+        const int length = snprintf(bound, sizeof(bound), "%g", workspaces.anytimeResult.bound);
+        out += ",\"bound\":";
+        out.append(bound, length);
+        out += workspaces.anytimeResult.optimal ? ",\"optimal\":true" : ",\"optimal\":false";
+    }
+    if (result->found) {
+        std::vector<int>& path = result->path;
+        // γ·Ԥһдꣻ·ʱӦ֣˻
+        size_t runCount = PATH_RUNS_INVALID;
+        if (task.pathFormat == PATH_OUTPUT_RUNS) {
+            if (workspaces.runs.size() < path.size()) workspaces.runs.resize(path.size());
+            runCount = EncodeDirectionRuns(path.data(), path.size(), width, workspaces.runs.data(), workspaces.runs.size());
+        }
+        if (runCount != PATH_RUNS_INVALID) {
+            out += ",\"runs\":\"";
+            AppendBase64(out, workspaces.runs.data(), runCount);
+            out += '"';
+        }
+        else {
+            size_t count = path.size();
+            if (task.pathFormat == PATH_OUTPUT_WAYPOINTS) {
+                count = CollapseWaypoints(path.data(), path.size(), width, path.data(), path.size());
+                out += ",\"waypoints\":[";
+            }
+            else {
+                out += ",\"path\":[";
+            }
+            for (size_t i = 0; i < count; i++) {
+                if (i > 0) out += ',';
+                AppendPoint(out, path[i], width);
+            }
+            out += ']';
+        }
+    }
+    out += ",\"queue_us\":";
+    AppendInt(out, MicrosBetween(task.received, begin));
+    out += ",\"search_us\":";
+    AppendInt(out, MicrosBetween(begin, end));
+}
+
+// ---------------------------------------------------------------------------
+// ̳߳أÿѯһӣÿ̸߳Լʱ
+
+class WorkerPool {
+public:
+    WorkerPool(int threadCount, ResponseWriter& responseWriter) : writer(responseWriter), active(0), stopping(false) {
+        for (int i = 0; i < threadCount; i++) {
+            threads.emplace_back(&WorkerPool::WorkerLoop, this);
+        }
+    }
+
+    void Submit(std::vector<QueryTask>& batch) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < batch.size(); i++) {
+                tasks.push_back(std::move(batch[i]));
+            }
+        }
+        batch.clear();
+        wake.notify_all();
+    }
+
+    // ύĲѯȫִ
+    void WaitIdle() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return tasks.empty() && active == 0; });
+    }
+
+    // ύĲѯ˳
+    void Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+    }
+
+private:
+    void WorkerLoop() {
+        QueryWorkspaces workspaces;
+
+        while (true) {
+            QueryTask task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                active++;
+            }
+
+            // ѯֱ߳ԼĻƴѯĽҪ浽
+            PendingResponse& response = *task.response;
+            std::string& text = workspaces.text;
+            text.clear();
+            if (response.isBatch) {
+                text += '{';
+            }
+            else {
+                text += "{\"id\":";
+                text += response.id;
+                text += ',';
+            }
+            ExecuteQuery(task, workspaces, text);
+            text += '}';
+
+            if (!response.isBatch) {
+                writer.Write(text);
+            }
+            else {
+                response.results[task.slot] = text;
+                if (response.remaining.fetch_sub(1) == 1) WriteResponse(response);
+            }
+            task = QueryTask();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            active--;
+            if (tasks.empty() && active == 0) idle.notify_all();
+        }
+    }
+
+    void WriteResponse(const PendingResponse& response) {
+        std::string line = "{\"id\":" + response.id + ",\"ok\":true,\"results\":[";
+        for (size_t i = 0; i < response.results.size(); i++) {
+            if (i > 0) line += ',';
+            line += response.results[i];
+        }
+        line += "]}";
+        writer.Write(line);
+    }
+
+    ResponseWriter& writer;
+    std::vector<std::thread> threads;
+    std::deque<QueryTask> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    int active;             // ִеĲѯ
+    bool stopping;
+};
+
+// ---------------------------------------------------------------------------
+// ַ
+
+class PathService {
+public:
+    PathService(std::ostream& output, const PathServiceOptions& serviceOptions)
+        : options(serviceOptions), writer(output),
+        pool(serviceOptions.workerThreads > 0 ? serviceOptions.workerThreads
+            : std::max(1, static_cast<int>(std::thread::hardware_concurrency())), writer) {}
+
+    // һ󣻷falseʾյquit
+    bool HandleLine(const std::string& line, Clock::time_point received) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) return true;
+
+        JsonValue request;
+        JsonParser parser(line);
+        if (!parser.Parse(request) || request.type != JsonValue::JSON_OBJECT) {
+            writer.Write(ErrorResponse("null", "invalid JSON"));
+            return true;
+        }
+
+        const std::string id = IdToJson(request.Find("id"));
+        const JsonValue* op = request.Find("op");
+        if (!op || op->type != JsonValue::JSON_STRING) {
+            writer.Write(ErrorResponse(id, "missing op"));
+            return true;
+        }
+
+        if (op->text == "quit") {
+            writer.Write("{\"id\":" + id + ",\"ok\":true}");
+            return false;
+        }
+
+        std::string error;
+        if (op->text == "load_map") {
+            if (LoadMap(request, error)) writer.Write("{\"id\":" + id + ",\"ok\":true}");
+            else writer.Write(ErrorResponse(id, error));
+        }
+        else if (op->text == "save_map") {
+            if (SaveMap(request, error)) writer.Write("{\"id\":" + id + ",\"ok\":true}");
+            else writer.Write(ErrorResponse(id, error));
+        }
+        else if (op->text == "build_path_db" || op->text == "load_path_db") {
+            if (AttachPathDatabase(request, op->text == "build_path_db", error)) writer.Write("{\"id\":" + id + ",\"ok\":true}");
+            else writer.Write(ErrorResponse(id, error));
+        }
+        else if (op->text == "set_walls") {
+            if (SetWalls(request, error)) writer.Write("{\"id\":" + id + ",\"ok\":true}");
+            else writer.Write(ErrorResponse(id, error));
+        }
+        else if (op->text == "distance_field") {
+            std::string response;
+            if (DistanceField(request, id, response, error)) writer.Write(response);
+            else writer.Write(ErrorResponse(id, error));
+        }
+        else if (op->text == "plan_agents") {
+            std::string response;
+            if (PlanAgentPaths(request, id, response, error)) writer.Write(response);
+            else writer.Write(ErrorResponse(id, error));
+        }
+        else if (op->text == "undo" || op->text == "redo") {
+            if (UndoWalls(request, op->text == "redo", error)) writer.Write("{\"id\":" + id + ",\"ok\":true}");
+            else writer.Write(ErrorResponse(id, error));
+        }
+        else if (op->text == "profile_start") {
+            if (StartProfile(request, error)) writer.Write("{\"id\":" + id + ",\"ok\":true}");
+            else writer.Write(ErrorResponse(id, error));
+        }
+        else if (op->text == "profile_stop") {
+            std::string response;
+            if (StopProfile(request, id, response, error)) writer.Write(response);
+            else writer.Write(ErrorResponse(id, error));
+        }
+        else if (op->text == "query" || op->text == "batch_query") {
+            if (!EnqueueQueries(request, id, op->text == "batch_query", received, error)) {
+                writer.Write(ErrorResponse(id, error));
+            }
+        }
+        else {
+            writer.Write(ErrorResponse(id, "unknown op: " + op->text));
+        }
+        return true;
+    }
+
+    bool HasPending() const { return !pending.empty(); }
+    Clock::time_point BatchDeadline() const { return batchDeadline; }
+
+    void FlushBatch() {
+        if (!pending.empty()) pool.Submit(pending);
+    }
+
+    void Shutdown() {
+        FlushBatch();
+        pool.Shutdown();
+    }
+
+private:
+    bool LoadMap(const JsonValue& request, std::string& error) {
+        const JsonValue* name = request.Find("map");
+        if (!name || name->type != JsonValue::JSON_STRING) { error = "missing map name"; return false; }
+
+        std::shared_ptr<ServiceMap> serviceMap = std::make_shared<ServiceMap>();
+        const JsonValue* rows = request.Find("rows");
+        const JsonValue* file = request.Find("file");
+
+        if (rows && rows->type == JsonValue::JSON_ARRAY && !rows->items.empty()) {
+            // ıͼ'#''@''T'Ϊǽͨ
+            int height = static_cast<int>(rows->items.size());
+            int width = static_cast<int>(rows->items[0].text.size());
+            serviceMap->map = GridMap(width, height);
+            for (int y = 0; y < height; y++) {
+                const std::string& row = rows->items[y].text;
+                if (static_cast<int>(row.size()) != width) { error = "rows must have equal length"; return false; }
+                for (int x = 0; x < width; x++) {
+                    char c = row[x];
+                    serviceMap->map.walls[serviceMap->map.Index(x, y)] = (c == '#' || c == '@' || c == 'T') ? 1 : 0;
+                }
+            }
+        }
+        else if (file && file->type == JsonValue::JSON_STRING) {
+            // ӻ߱ĶƵͼԤͼһʱֱʹ
+            const JsonValue* widthValue = request.Find("width");
+            const JsonValue* heightValue = request.Find("height");
+            int width = widthValue ? widthValue->AsInt() : 40;
+            int height = heightValue ? heightValue->AsInt() : 30;
+            if (width <= 0 || height <= 0) { error = "invalid map size"; return false; }
+
+            std::vector<MapChunk> chunks;
+            if (!LoadMapFile(file->text, width, height, serviceMap->map, chunks)) {
+                error = "cannot read " + file->text;
+                return false;
+            }
+            const MapChunk* chunk = FindMapChunk(chunks, MAP_CHUNK_SUBGOAL_GRAPH);
+            if (chunk && serviceMap->subgoals->data.Deserialize(chunk->payload, serviceMap->map)) {
+                serviceMap->subgoals->ready = true;
+            }
+            chunk = FindMapChunk(chunks, MAP_CHUNK_JUMP_TABLE);
+            if (chunk && serviceMap->jumpTable->data.Deserialize(chunk->payload, serviceMap->map)) {
+                serviceMap->jumpTable->ready = true;
+            }
+            chunk = FindMapChunk(chunks, MAP_CHUNK_RECTANGLES);
+            if (chunk && serviceMap->rectangles->data.Deserialize(chunk->payload, serviceMap->map)) {
+                serviceMap->rectangles->ready = true;
+            }
+        }
+        else {
+            error = "load_map needs rows or file";
+            return false;
+        }
+
+        serviceMap->grid.Build(serviceMap->map);
+        maps[name->text] = serviceMap;
+        journals.erase(name->text);
+        return true;
+    }
+
+    bool SetWalls(const JsonValue& request, std::string& error) {
+        MapSnapshot current = FindMap(request, error);
+        if (!current) return false;
+
+        const JsonValue* cells = request.Find("cells");
+        if (!cells || cells->type != JsonValue::JSON_ARRAY) { error = "missing cells"; return false; }
+
+        // ΪһظӺϲδ仯ĸӶһӦ
+        EditTransaction edit(current->map.width);
+        for (size_t i = 0; i < cells->items.size(); i++) {
+            const JsonValue& cell = cells->items[i];
+            if (cell.items.size() < 2) { error = "cell must be [x, y, wall]"; return false; }
+            int x = cell.items[0].AsInt(-1);
+            int y = cell.items[1].AsInt(-1);
+            bool wall = cell.items.size() < 3 || cell.items[2].number != 0;
+            if (!current->map.InBounds(x, y)) { error = "cell out of bounds"; return false; }
+            const int index = current->map.Index(x, y);
+            edit.Set(index, current->map.walls[index], wall ? 1 : 0);
+        }
+        edit.Normalize();
+
+        const std::string& name = request.Find("map")->text;
+        current.reset();
+        ApplyWallEdit(name, edit);
+        journals[name].Record(edit);
+        return true;
+    }
+
+    // õͼһset_walls
+    bool UndoWalls(const JsonValue& request, bool redo, std::string& error) {
+        if (!FindMap(request, error)) return false;
+
+        const std::string& name = request.Find("map")->text;
+        EditTransaction edit;
+        EditJournal& journal = journals[name];
+        if (redo ? !journal.Redo(edit) : !journal.Undo(edit)) {
+            error = redo ? "nothing to redo" : "nothing to undo";
+            return false;
+        }
+        ApplyWallEdit(name, edit);
+        return true;
+    }
+
+    // ȡÿ޸ĵĵͼգύĲѯȫִֻmapsУֱӷأ
+    // ÷Գʱһ滻
+    std::shared_ptr<ServiceMap> ExclusiveMap(const std::string& name) {
+        FlushBatch();
+        pool.WaitIdle();
+        std::shared_ptr<ServiceMap>& serviceMap = maps[name];
+        if (serviceMap.use_count() > 1) {
+            serviceMap = std::make_shared<ServiceMap>(*serviceMap);
+            serviceMap->subgoals = CopyCache(*serviceMap->subgoals);
+            serviceMap->jumpTable = CopyCache(*serviceMap->jumpTable);
+            serviceMap->rectangles = CopyCache(*serviceMap->rectangles);
+        }
+        return serviceMap;
+    }
+
+    // ԭӦõ޸ģֻĶ漰ĸӣѽõԾηֽⰴĶ£
+    // Ŀͼ·ݿȫͼĿɴϵʧЧؽ
+    void ApplyWallEdit(const std::string& name, const EditTransaction& edit) {
+        std::shared_ptr<ServiceMap> serviceMap = ExclusiveMap(name);
+
+        std::vector<int> changed;
+        changed.reserve(edit.Size());
+        for (const CellDelta& delta : edit.Deltas()) {
+            serviceMap->map.walls[delta.cell] = delta.after;
+            serviceMap->grid.SetWall(delta.cell % serviceMap->map.width, delta.cell / serviceMap->map.width, delta.after != 0);
+            changed.push_back(delta.cell);
+        }
+
+        // δõԤ״βѯʱ޸ĺĵͼ
+        if (serviceMap->jumpTable->ready) serviceMap->jumpTable->data.SetWalls(serviceMap->map, changed);
+        if (serviceMap->rectangles->ready) serviceMap->rectangles->data.SetWalls(serviceMap->map, changed);
+        serviceMap->subgoals = std::make_shared<PreprocessCache<SubgoalGraph> >();
+        serviceMap->pathDatabase.reset();
+    }
+
+    // ʼͳƸõͼϲѯչȶȣͳʱ
+    bool StartProfile(const JsonValue& request, std::string& error) {
+        MapSnapshot current = FindMap(request, error);
+        if (!current) return false;
+        profilers[request.Find("map")->text] = std::make_shared<SearchProfiler>(current->map.width, current->map.height);
+        return true;
+    }
+
+    // ͳƣύĲѯȫִٺϲ̵߳ļѡΪCSVƻBMPȶͼ
+    bool StopProfile(const JsonValue& request, const std::string& id, std::string& response, std::string& error) {
+        const JsonValue* name = request.Find("map");
+        if (!name || name->type != JsonValue::JSON_STRING) { error = "missing map name"; return false; }
+        auto found = profilers.find(name->text);
+        if (found == profilers.end()) { error = "map is not being profiled: " + name->text; return false; }
+        std::shared_ptr<SearchProfiler> profiler = found->second;
+        profilers.erase(found);
+
+        FlushBatch();
+        pool.WaitIdle();
+        ProfileCounters total;
+        profiler->Merge(total);
+
+        const JsonValue* counter = request.Find("counter");
+        const ProfileCounter which = counter && counter->text == "pushed" ? PROFILE_PUSHED : PROFILE_EXPANDED;
+        const JsonValue* file = request.Find("file");
+        if (file && file->type == JsonValue::JSON_STRING) {
+            const JsonValue* format = request.Find("format");
+            const std::string formatText = format && format->type == JsonValue::JSON_STRING ? format->text : "csv";
+            const JsonValue* cellPixels = request.Find("cell_pixels");
+            auto current = maps.find(name->text);
+            const GridMap* walls = current != maps.end() ? &current->second->map : nullptr;
+
+            bool written;
+            if (formatText == "csv") written = WriteProfileCsv(file->text, total, which);
+            else if (formatText == "binary") written = WriteProfileBinary(file->text, total);
+            else if (formatText == "bmp") written = WriteProfileHeatmap(file->text, total, which, walls, cellPixels ? cellPixels->AsInt(4) : 4);
+            else { error = "unknown format: " + formatText; return false; }
+            if (!written) { error = "cannot write " + file->text; return false; }
+        }
+
+        unsigned long long expanded = 0, pushed = 0;
+        for (size_t i = 0; i < total.expanded.size(); i++) {
+            expanded += total.expanded[i];
+            pushed += total.pushed[i];
+        }
+        std::ostringstream out;
+        out << "{\"id\":" << id << ",\"ok\":true,\"queries\":" << total.queries << ",\"expanded\":" << expanded
+            << ",\"pushed\":" << pushed << "}";
+        response = out.str();
+        return true;
+    }
+
+    // ŵͼľ볡"kind"Ϊ"cost"10/14ۣĬϣ"steps""wall"ǽľ룩
+    bool DistanceField(const JsonValue& request, const std::string& id, std::string& response, std::string& error) {
+        MapSnapshot current = FindMap(request, error);
+        if (!current) return false;
+
+        const JsonValue* kind = request.Find("kind");
+        const std::string kindText = kind && kind->type == JsonValue::JSON_STRING ? kind->text : "cost";
+
+        std::vector<int> sources;
+        const JsonValue* sourceList = request.Find("sources");
+        if (kindText != "wall") {
+            if (!sourceList || sourceList->type != JsonValue::JSON_ARRAY) { error = "missing sources"; return false; }
+            for (size_t i = 0; i < sourceList->items.size(); i++) {
+                int x, y;
+                if (!ReadPoint(&sourceList->items[i], x, y) || !current->map.InBounds(x, y)) {
+                    error = "invalid source";
+                    return false;
+                }
+                sources.push_back(current->map.Index(x, y));
+            }
+        }
+
+        SearchOptions options;
+        const JsonValue* connectivity = request.Find("connectivity");
+        options.connectivity = connectivity && connectivity->AsInt() == 4 ? 4 : 8;
+        const JsonValue* corner = request.Find("corner");
+        options.cornerRule = corner && corner->text == "any" ? CORNER_BLOCK_ANY : CORNER_BLOCK_BOTH;
+
+        std::vector<int> distances;
+        if (kindText == "cost") ComputeCostField(current->map, sources, options, distances);
+        else if (kindText == "steps") ComputeStepField(current->map, sources, options, distances);
+        else if (kindText == "wall") ComputeWallDistance(current->map, distances);
+        else { error = "unknown kind: " + kindText; return false; }
+
+        std::ostringstream out;
+        out << "{\"id\":" << id << ",\"ok\":true,\"width\":" << current->map.width << ",\"height\":" << current->map.height
+            << ",\"distances\":[";
+        for (size_t i = 0; i < distances.size(); i++) {
+            if (i > 0) out << ',';
+            out << distances[i];
+        }
+        out << "]}";
+        response = out.str();
+        return true;
+    }
+
+    // ȼ滮agents˳滮ÿ·ʱ䲽λãԭصȴ
+    bool PlanAgentPaths(const JsonValue& request, const std::string& id, std::string& response, std::string& error) {
+        MapSnapshot current = FindMap(request, error);
+        if (!current) return false;
+
+        const JsonValue* agents = request.Find("agents");
+        if (!agents || agents->type != JsonValue::JSON_ARRAY) { error = "missing agents"; return false; }
+        std::vector<AgentTask> tasks(agents->items.size());
+        for (size_t i = 0; i < agents->items.size(); i++) {
+            AgentTask& task = tasks[i];
+            if (!ReadPoint(agents->items[i].Find("start"), task.startX, task.startY) ||
+                !ReadPoint(agents->items[i].Find("goal"), task.goalX, task.goalY)) {
+                error = "agent needs start and goal as [x, y]";
+                return false;
+            }
+        }
+
+        MultiAgentOptions options;
+        const JsonValue* connectivity = request.Find("connectivity");
+        options.search.connectivity = connectivity && connectivity->AsInt() == 4 ? 4 : 8;
+        const JsonValue* corner = request.Find("corner");
+        options.search.cornerRule = corner && corner->text == "any" ? CORNER_BLOCK_ANY : CORNER_BLOCK_BOTH;
+        const JsonValue* horizon = request.Find("horizon");
+        options.horizon = horizon ? horizon->AsInt(0) : 0;
+        const JsonValue* field = request.Find("field_heuristic");
+        options.fieldHeuristic = field && field->type == JsonValue::JSON_BOOL && field->number != 0;
+        // չޣΪʱĬֵ
+        const JsonValue* maxExpansions = request.Find("max_expansions");
+        if (maxExpansions && maxExpansions->AsInt(0) > 0) options.maxExpansions = static_cast<size_t>(maxExpansions->AsInt(0));
+
+        Clock::time_point begin = Clock::now();
+        std::vector<AgentPlan> plans;
+        size_t solved = PlanAgents(current->map, tasks, options, plans);
+        Clock::time_point end = Clock::now();
+
+        size_t gaveUp = 0;
+        for (size_t i = 0; i < plans.size(); i++) {
+            if (plans[i].gaveUp) gaveUp++;
+        }
+
+        std::ostringstream out;
+        out << "{\"id\":" << id << ",\"ok\":true,\"solved\":" << solved << ",\"unplanned\":" << plans.size() - solved
+            << ",\"gave_up\":" << gaveUp << ",\"agents\":[";
+        for (size_t i = 0; i < plans.size(); i++) {
+            const AgentPlan& plan = plans[i];
+            if (i > 0) out << ',';
+            out << "{\"found\":" << (plan.found ? "true" : "false");
+            if (plan.found) out << ",\"cost\":" << plan.cost;
+            if (plan.gaveUp) out << ",\"gave_up\":true";
+            out << ",\"path\":[";
+            for (size_t t = 0; t < plan.path.size(); t++) {
+                if (t > 0) out << ',';
+                out << '[' << plan.path[t] % current->map.width << ',' << plan.path[t] / current->map.width << ']';
+            }
+            out << "]}";
+        }
+        out << "],\"search_us\":" << MicrosBetween(begin, end) << '}';
+        response = out.str();
+        return true;
+    }
+
+    // ͼĿͼԾվηֽ⹩´ʱԤ
+    bool SaveMap(const JsonValue& request, std::string& error) {
+        MapSnapshot current = FindMap(request, error);
+        if (!current) return false;
+
+        const JsonValue* file = request.Find("file");
+        if (!file || file->type != JsonValue::JSON_STRING) { error = "save_map needs file"; return false; }
+
+        std::vector<MapChunk> chunks(3);
+        chunks[0].tag = MAP_CHUNK_SUBGOAL_GRAPH;
+        chunks[0].payload = current->subgoals->Get(current->map).Serialize();
+        chunks[1].tag = MAP_CHUNK_JUMP_TABLE;
+        chunks[1].payload = current->jumpTable->Get(current->map).Serialize(current->map);
+        chunks[2].tag = MAP_CHUNK_RECTANGLES;
+        chunks[2].payload = current->rectangles->Get(current->map).Serialize(current->map);
+        if (!SaveMapFile(file->text, current->map, chunks)) {
+            error = "cannot write " + file->text;
+            return false;
+        }
+        return true;
+    }
+
+    // ѡ棩ڴӳ䷽ʽѹ·ݿ⣬ҵµĵͼ
+    bool AttachPathDatabase(const JsonValue& request, bool build, std::string& error) {
+        MapSnapshot current = FindMap(request, error);
+        if (!current) return false;
+
+        const JsonValue* file = request.Find("file");
+        if (file && file->type != JsonValue::JSON_STRING) { error = "file must be a string"; return false; }
+        if (!build && !file) { error = "load_path_db needs file"; return false; }
+
+        std::shared_ptr<PathDatabase> database = std::make_shared<PathDatabase>();
+        if (build) {
+            if (!database->Build(current->map, options.workerThreads)) { error = "map too large for path database"; return false; }
+            if (file && !database->Save(file->text)) { error = "cannot write " + file->text; return false; }
+        }
+        else if (!database->Open(file->text, current->map)) {
+            error = "cannot open " + file->text + " or it does not match the map";
+            return false;
+        }
+
+        current.reset();
+        ExclusiveMap(request.Find("map")->text)->pathDatabase = database;
+        return true;
+    }
+
+    MapSnapshot FindMap(const JsonValue& request, std::string& error) {
+        const JsonValue* name = request.Find("map");
+        if (!name || name->type != JsonValue::JSON_STRING) { error = "missing map name"; return MapSnapshot(); }
+        auto found = maps.find(name->text);
+        if (found == maps.end()) { error = "unknown map: " + name->text; return MapSnapshot(); }
+        return found->second;
+    }
+
+    static bool ReadPoint(const JsonValue* value, int& x, int& y) {
+        if (!value || value->type != JsonValue::JSON_ARRAY || value->items.size() != 2) return false;
+        x = value->items[0].AsInt(-1);
+        y = value->items[1].AsInt(-1);
+        return true;
+    }
+
+    // 󣨻еһȡѯȱʡֵȡ
+    static bool ReadQuery(const JsonValue& query, const JsonValue& outer, const GridMap& map, QueryTask& task,
+        std::string& error) {
+        const JsonValue* goalList = query.Find("goals");
+        if (!ReadPoint(query.Find("start"), task.startX, task.startY) ||
+            (!goalList && !ReadPoint(query.Find("goal"), task.goalX, task.goalY))) {
+            error = "query needs start and goal as [x, y]";
+            return false;
+        }
+        if (goalList) {
+            if (goalList->type != JsonValue::JSON_ARRAY || goalList->items.empty()) {
+                error = "goals must be a non-empty array of [x, y]";
+                return false;
+            }
+            std::shared_ptr<GoalSet> goals = std::make_shared<GoalSet>();
+            goals->Reset(map.width, map.height);
+            for (size_t i = 0; i < goalList->items.size(); i++) {
+                int x, y;
+                if (!ReadPoint(&goalList->items[i], x, y)) { error = "goals must be a non-empty array of [x, y]"; return false; }
+                // ԽǽϵյԶˣܾѯĶ
+                if (!map.InBounds(x, y) || map.IsWall(x, y) || !goals->Add(x, y)) {
+                    error = "goal out of bounds or on a wall";
+                    return false;
+                }
+            }
+            task.goals = goals;
+        }
+
+        const JsonValue* connectivity = query.Find("connectivity");
+        if (!connectivity) connectivity = outer.Find("connectivity");
+        task.search.connectivity = connectivity && connectivity->AsInt() == 4 ? 4 : 8;
+
+        const JsonValue* corner = query.Find("corner");
+        if (!corner) corner = outer.Find("corner");
+        task.search.cornerRule = corner && corner->text == "any" ? CORNER_BLOCK_ANY : CORNER_BLOCK_BOTH;
+
+        const JsonValue* deadline = query.Find("deadline_us");
+        if (!deadline) deadline = outer.Find("deadline_us");
+        task.deadlineMicros = deadline ? static_cast<long long>(deadline->number) : 0;
+
+        const JsonValue* engine = query.Find("engine");
+        if (!engine) engine = outer.Find("engine");
+        if (engine && engine->text == "subgoal") task.engine = QUERY_ENGINE_SUBGOAL;
+        else if (engine && engine->text == "jps") task.engine = QUERY_ENGINE_JPS_PLUS;
+        else if (engine && engine->text == "rsr") task.engine = QUERY_ENGINE_RECTANGLES;
+        else if (engine && engine->text == "path_db") task.engine = QUERY_ENGINE_PATH_DB;
+        else if (engine && engine->text == "parallel") task.engine = QUERY_ENGINE_PARALLEL;
+        else task.engine = QUERY_ENGINE_GRID;
+
+        const JsonValue* format = query.Find("path_format");
+        if (!format) format = outer.Find("path_format");
+        if (format && format->text == "waypoints") task.pathFormat = PATH_OUTPUT_WAYPOINTS;
+        else if (format && format->text == "runs") task.pathFormat = PATH_OUTPUT_RUNS;
+        else task.pathFormat = PATH_OUTPUT_CELLS;
+
+        const JsonValue* threads = query.Find("threads");
+        if (!threads) threads = outer.Find("threads");
+        task.threads = threads ? threads->AsInt() : 0;
+
+        // յѯֻA*һʵ֣Ҳûдֹʱİ汾
+        if (task.goals && task.engine != QUERY_ENGINE_GRID) {
+            error = "goals query supports only the grid engine";
+            return false;
+        }
+        if (task.goals && task.deadlineMicros > 0) {
+            error = "goals query does not support deadline";
+            return false;
+        }
+        if (task.engine == QUERY_ENGINE_PARALLEL && task.deadlineMicros > 0) {
+            error = "parallel engine does not support deadline";
+            return false;
+        }
+        if (task.engine != QUERY_ENGINE_GRID && task.engine != QUERY_ENGINE_PARALLEL && (task.search.connectivity != 8 ||
+            task.search.cornerRule != CORNER_BLOCK_BOTH || task.deadlineMicros > 0)) {
+            error = engine->text + " engine supports only 8-connectivity with corner \"both\" and no deadline";
+            return false;
+        }
+        if (task.engine == QUERY_ENGINE_JPS_PLUS && !JumpTable::Supports(map)) {
+            error = "jps engine supports maps up to " + std::to_string(JUMP_TABLE_MAX_SIDE) + " cells per side";
+            return false;
+        }
+        return true;
+    }
+
+    bool EnqueueQueries(const JsonValue& request, const std::string& id, bool isBatch,
+        Clock::time_point received, std::string& error) {
+        MapSnapshot map = FindMap(request, error);
+        if (!map) return false;
+
+        std::vector<const JsonValue*> queries;
+        if (isBatch) {
+            const JsonValue* list = request.Find("queries");
+            if (!list || list->type != JsonValue::JSON_ARRAY || list->items.empty()) {
+                error = "batch_query needs a non-empty queries array";
+                return false;
+            }
+            for (size_t i = 0; i < list->items.size(); i++) queries.push_back(&list->items[i]);
+        }
+        else {
+            queries.push_back(&request);
+        }
+
+        // ͼΪͬߴԭͳƲټ
+        std::shared_ptr<SearchProfiler> profiler;
+        auto profiling = profilers.find(request.Find("map")->text);
+        if (profiling != profilers.end() && profiling->second->Width() == map->map.width &&
+            profiling->second->Height() == map->map.height) {
+            profiler = profiling->second;
+        }
+
+        std::shared_ptr<PendingResponse> response = std::make_shared<PendingResponse>();
+        response->id = id;
+        response->isBatch = isBatch;
+        response->results.resize(queries.size());
+        response->remaining = queries.size();
+
+        std::vector<QueryTask> tasks(queries.size());
+        for (size_t i = 0; i < queries.size(); i++) {
+            if (!ReadQuery(*queries[i], request, map->map, tasks[i], error)) return false;
+            if (tasks[i].engine == QUERY_ENGINE_PATH_DB && !map->pathDatabase) {
+                error = "no path database for this map, send build_path_db or load_path_db first";
+                return false;
+            }
+            tasks[i].map = map;
+            tasks[i].profiler = profiler;
+            tasks[i].received = received;
+            tasks[i].response = response;
+            tasks[i].slot = i;
+        }
+
+        if (pending.empty()) {
+            batchDeadline = received + std::chrono::microseconds(options.batchWindowMicros);
+        }
+        for (size_t i = 0; i < tasks.size(); i++) {
+            pending.push_back(std::move(tasks[i]));
+        }
+        if (pending.size() >= options.maxBatchSize) FlushBatch();
+        return true;
+    }
+
+    PathServiceOptions options;
+    ResponseWriter writer;
+    WorkerPool pool;
+    std::map<std::string, std::shared_ptr<ServiceMap> > maps;
+    std::map<std::string, EditJournal> journals;    // ÿŵͼset_walls¼
+    std::map<std::string, std::shared_ptr<SearchProfiler> > profilers;   // ͳչȶȵĵͼ
+    std::vector<QueryTask> pending;
+    Clock::time_point batchDeadline;
+};
+
+} // namespace
+
+// ȡַ̹߳߳
+struct InputQueue {
+    std::mutex mutex;
+    std::condition_variable arrived;
+    std::deque<std::pair<std::string, Clock::time_point> > lines;
+    bool closed = false;
+};
+
+int RunPathService(std::istream& input, std::ostream& output, const PathServiceOptions& options) {
+    PathService service(output, options);
+
+    // ȡֻ߳Уַ߳̾ݴ˾ʱύ
+    std::shared_ptr<InputQueue> queue = std::make_shared<InputQueue>();
+    std::thread reader([queue, &input] {
+        std::string line;
+        while (std::getline(input, line)) {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            queue->lines.push_back(std::make_pair(line, Clock::now()));
+            queue->arrived.notify_one();
+        }
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->closed = true;
+        queue->arrived.notify_one();
+    });
+
+    bool running = true;
+    bool closed = false;
+    while (running) {
+        std::pair<std::string, Clock::time_point> next;
+        bool hasLine = false;
+        {
+            std::unique_lock<std::mutex> lock(queue->mutex);
+            auto ready = [&] { return !queue->lines.empty() || queue->closed; };
+            if (service.HasPending()) {
+                queue->arrived.wait_until(lock, service.BatchDeadline(), ready);
+            }
+            else {
+                queue->arrived.wait(lock, ready);
+            }
+            if (!queue->lines.empty()) {
+                next = queue->lines.front();
+                queue->lines.pop_front();
+                hasLine = true;
+            }
+            closed = queue->closed && queue->lines.empty();
+        }
+
+        if (hasLine) {
+            running = service.HandleLine(next.first, next.second);
+        }
+        if (service.HasPending() && (!running || closed || Clock::now() >= service.BatchDeadline())) {
+            service.FlushBatch();
+        }
+        if (closed && !hasLine) running = false;
+    }
+
+    service.Shutdown();
+    // յquitʱȡ߳̿ϣֻйУֱӷ
+    if (closed) reader.join();
+    else reader.detach();
+    return 0;
+}
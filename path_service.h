@@ -0,0 +1,51 @@
+#pragma once
+
+#include <iosfwd>
+
+// פѰ·ѯ񣺱ֵͼפڴ棬жȡJSON
+//
+// ÿһJSON"id"ԭش
+//   {"id":1,"op":"load_map","map":"m","width":40,"height":30,"rows":["..#.",...]}
+//   {"id":2,"op":"load_map","map":"m","file":"map.bin"}          ӻ߱ĵͼ40x30
+//   {"id":3,"op":"set_walls","map":"m","cells":[[x,y,1],[x,y,0]]}  Ϊһ޸Ӧãundo/redo
+//   {"id":4,"op":"query","map":"m","start":[x,y],"goal":[x,y]}   ѡ"connectivity":4/8"corner":"both"/"any""deadline_us"
+//                                                                "engine":"subgoal"ʹĿͼ״βѯʱ
+//                                                                "engine":"jps"ʹJPS+Ծ״βѯʱset_wallsʱ£
+//                                                                "engine":"rsr"ζԳ״βѯʱʺϴƬյأ
+//                                                                "engine":"path_db"ʹѹ·ݿ⣩
+//                                                                "engine":"parallel"̲߳A*ѡ"threads"ڵѯ
+//                                                                "goals":[[x,y],...]"goal"ʱΪյѯһյ㣬
+//                                                                "goal"Ϊյ㣻"deadline_us"ͬã
+//                                                                κһյԽǽʱѯش
+//                                                                ѡ"path_format""cells"Ĭϣ"waypoints"ֻյ㣩
+//                                                                "runs"γֽڵbase64path_encoding.hѯд
+//   {"id":5,"op":"batch_query","map":"m","queries":[{"start":[x,y],"goal":[x,y]},...]}
+//   {"id":6,"op":"save_map","map":"m","file":"map.bin"}          ͼĿͼԾվηֽ
+//   {"id":7,"op":"build_path_db","map":"m","file":"map.cpd"}     ѹ·ݿ⣨ȫԤfileʡԣ
+//   {"id":8,"op":"load_path_db","map":"m","file":"map.cpd"}      ڴӳ䷽ʽѹݿ
+//   {"id":9,"op":"undo","map":"m"}  /  {"id":10,"op":"redo","map":"m"}
+//   {"id":11,"op":"distance_field","map":"m","sources":[[x,y],...],"kind":"cost"}
+//                                                                ŵͼľ볡"kind"Ϊ"cost"10/14ۣ-1Ϊǽ򲻿ɴ
+//                                                                "steps""wall"ǽľ룬Ҫsources
+//   {"id":12,"op":"plan_agents","map":"m","agents":[{"start":[x,y],"goal":[x,y]},...]}
+//                                                                ײ滮ʱA*˳ȼÿ
+//                                                                pathtΪtʱ̵λãѡ"horizon""field_heuristic"
+//                                                                "max_expansions"չޣĬΪ4
+//                                                                δ滮unplannedgave_upﵽչ
+//   {"id":13,"op":"profile_start","map":"m"}                     ʼۼƸõͼϲѯÿչӴ
+//   {"id":14,"op":"profile_stop","map":"m","file":"heat.bmp","format":"bmp"}
+//                                                                ͳƲfileʱ"format"Ϊ"csv"Ĭϣ
+//                                                                "binary""bmp"ѡ"cell_pixels""counter"Ϊ"expanded""pushed"
+//   {"id":15,"op":"quit"}
+//
+// ʱ䴰ڵĲѯϲΪһύ̳߳أɼidӦ
+// ÿŶӺʱqueue_usʱsearch_us
+
+struct PathServiceOptions {
+    int workerThreads = 0;              // ߳0ʾʹӲ߳
+    long long batchWindowMicros = 2000; // ϲεʱ䴰
+    size_t maxBatchSize = 256;          // ѯ
+};
+
+// вѯֱյquitؽ˳
+int RunPathService(std::istream& input, std::ostream& output, const PathServiceOptions& options);
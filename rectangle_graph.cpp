@@ -0,0 +1,325 @@
+#include "rectangle_graph.h"
+#include "map_file.h"
+
+#include <algorithm>
+
+namespace {
+
+// fromto֮䣨fromtoĸ׷ӵpath߶Խֱߡ
+// 㲻ʱͬһվڣĸӶİΧУǽ
+void AppendSegment(int fromX, int fromY, int toX, int toY, int width, std::vector<int>& path) {
+    const int stepX = toX > fromX ? 1 : -1;
+    const int stepY = toY > fromY ? 1 : -1;
+    int x = fromX, y = fromY;
+    while (x != toX || y != toY) {
+        if (x != toX) x += stepX;
+        if (y != toY) y += stepY;
+        path.push_back(y * width + x);
+    }
+}
+
+} // namespace
+
+void RectangleGraph::Build(const GridMap& map) {
+    width = map.width;
+    height = map.height;
+    rectangles.clear();
+    rectangleOfCell.assign(static_cast<size_t>(width) * height, -1);
+    Decompose(map, 0, 0, width - 1, height - 1);
+}
+
+void RectangleGraph::Decompose(const GridMap& map, int left, int top, int right, int bottom) {
+    auto isFree = [&](int x, int y) {
+        return map.InBounds(x, y) && !map.walls[map.Index(x, y)] && rectangleOfCell[map.Index(x, y)] < 0;
+    };
+    auto rowFree = [&](int y, int x0, int x1) {
+        for (int x = x0; x <= x1; x++) {
+            if (!isFree(x, y)) return false;
+        }
+        return true;
+    };
+    auto columnFree = [&](int x, int y0, int y1) {
+        for (int y = y0; y <= y1; y++) {
+            if (!isFree(x, y)) return false;
+        }
+        return true;
+    };
+
+    // ɨ裬ÿδռõĿոȳΣپҡ죻
+    // ̫խľûڲӣռЩӣľ
+    for (int y = top; y <= bottom; y++) {
+        for (int x = left; x <= right; x++) {
+            if (!isFree(x, y)) continue;
+
+            int r = x, b = y;
+            while (rowFree(b + 1, x, r + 1) && columnFree(r + 1, y, b)) {
+                r++;
+                b++;
+            }
+            while (columnFree(r + 1, y, b)) r++;
+            while (rowFree(b + 1, x, r)) b++;
+            if (r - x + 1 < RECTANGLE_MIN_SIDE || b - y + 1 < RECTANGLE_MIN_SIDE) continue;
+            AddRectangle({ x, y, r, b });
+        }
+    }
+}
+
+void RectangleGraph::AddRectangle(const EmptyRectangle& rectangle) {
+    const int id = static_cast<int>(rectangles.size());
+    rectangles.push_back(rectangle);
+    for (int y = rectangle.top; y <= rectangle.bottom; y++) {
+        std::fill(rectangleOfCell.begin() + y * width + rectangle.left, rectangleOfCell.begin() + y * width + rectangle.right + 1, id);
+    }
+}
+
+void RectangleGraph::SetWalls(const GridMap& map, const std::vector<int>& cells) {
+    if (cells.empty()) return;
+    if (!IsBuiltFor(map)) {
+        Build(map);
+        return;
+    }
+
+    // иĶӵľȥǽʹ䲻ΪգǽҲܲľΣ
+    // ٶЩĶӵİΧ·ֽ
+    int left = width, top = height, right = -1, bottom = -1;
+    auto include = [&](int x0, int y0, int x1, int y1) {
+        left = std::min(left, x0);
+        top = std::min(top, y0);
+        right = std::max(right, x1);
+        bottom = std::max(bottom, y1);
+    };
+    std::vector<int> removed;
+    for (int cell : cells) {
+        include(cell % width, cell / width, cell % width, cell / width);
+        if (rectangleOfCell[cell] >= 0) removed.push_back(rectangleOfCell[cell]);
+    }
+    std::sort(removed.begin(), removed.end());
+    removed.erase(std::unique(removed.begin(), removed.end()), removed.end());
+
+    // ӴСɾһλֻ±Ǳƶľ
+    for (auto it = removed.rbegin(); it != removed.rend(); ++it) {
+        const int id = *it;
+        const EmptyRectangle gone = rectangles[id];
+        include(gone.left, gone.top, gone.right, gone.bottom);
+        for (int y = gone.top; y <= gone.bottom; y++) {
+            std::fill(rectangleOfCell.begin() + y * width + gone.left, rectangleOfCell.begin() + y * width + gone.right + 1, -1);
+        }
+        const int last = static_cast<int>(rectangles.size()) - 1;
+        if (id != last) {
+            const EmptyRectangle& moved = rectangles[last];
+            for (int y = moved.top; y <= moved.bottom; y++) {
+                std::fill(rectangleOfCell.begin() + y * width + moved.left, rectangleOfCell.begin() + y * width + moved.right + 1, id);
+            }
+            rectangles[id] = moved;
+        }
+        rectangles.pop_back();
+    }
+
+    Decompose(map, left, top, right, bottom);
+}
+
+void RectangleGraph::IndexRectangles() {
+    rectangleOfCell.assign(static_cast<size_t>(width) * height, -1);
+    for (size_t i = 0; i < rectangles.size(); i++) {
+        const EmptyRectangle& r = rectangles[i];
+        for (int y = r.top; y <= r.bottom; y++) {
+            std::fill(rectangleOfCell.begin() + y * width + r.left, rectangleOfCell.begin() + y * width + r.right + 1,
+                static_cast<int>(i));
+        }
+    }
+}
+
+size_t RectangleGraph::PrunedCount() const {
+    size_t count = 0;
+    for (const EmptyRectangle& r : rectangles) {
+        count += static_cast<size_t>(r.right - r.left - 1) * (r.bottom - r.top - 1);
+    }
+    return count;
+}
+
+bool RectangleGraph::FindPath(const GridMap& map, int startX, int startY, int goalX, int goalY,
+    SearchWorkspace& ws, SearchResult& result) const {
+    result.found = false;
+    result.cost = 0;
+    result.path.clear();
+    result.expanded = 0;
+
+    if (!IsBuiltFor(map) || map.IsWall(startX, startY) || map.IsWall(goalX, goalY)) return false;
+
+    const int start = map.Index(startX, startY);
+    const int goal = map.Index(goalX, goalY);
+
+    // յͬһڣûǽ˷뼴ֻ̣չ㣬ȶͳͬ
+    if (RectangleOf(start) >= 0 && RectangleOf(start) == RectangleOf(goal)) {
+        result.expanded = 1;
+        SEARCH_PROFILE_EXPAND(ws, startX, startY);
+        result.path.push_back(start);
+        AppendSegment(startX, startY, goalX, goalY, width, result.path);
+        result.cost = OctileDistance(startX, startY, goalX, goalY);
+        result.found = true;
+        return true;
+    }
+    const int startRectangle = IsInterior(startX, startY) ? RectangleOf(start) : -1;
+    const int goalRectangle = IsInterior(goalX, goalY) ? RectangleOf(goal) : -1;
+
+    ws.Begin(map.CellCount());
+    std::vector<GridOpenEntry<int> >& openSet = ws.OpenStorage<int>();
+    openSet.clear();
+    ws.Open(start, 0, -1);
+    openSet.push_back({ OctileDistance(startX, startY, goalX, goalY), 0, start });
+    SEARCH_PROFILE_PUSH(ws, startX, startY);
+
+    auto push = [&](int from, int x, int y, int cost) {
+        const int to = map.Index(x, y);
+        if (ws.IsClosed(to)) return;
+        const int newG = ws.g[from] + cost;
+        if (newG >= ws.G(to)) return;
+        ws.Open(to, newG, from);
+        openSet.push_back({ newG + OctileDistance(x, y, goalX, goalY), newG, to });
+        std::push_heap(openSet.begin(), openSet.end());
+        SEARCH_PROFILE_PUSH(ws, x, y);
+    };
+
+    bool found = false;
+    while (!openSet.empty()) {
+        std::pop_heap(openSet.begin(), openSet.end());
+        const GridOpenEntry<int> top = openSet.back();
+        openSet.pop_back();
+        const int cell = top.cell;
+        if (ws.IsClosed(cell)) continue;
+        ws.Close(cell);
+        result.expanded++;
+        SEARCH_PROFILE_EXPAND(ws, cell % width, cell / width);
+
+        if (cell == goal) {
+            found = true;
+            break;
+        }
+
+        const int x = cell % width;
+        const int y = cell / width;
+        auto macro = [&](int toX, int toY) { push(cell, toX, toY, OctileDistance(x, y, toX, toY)); };
+
+        // ھڲֱþεȫ߽
+        if (cell == start && startRectangle >= 0) {
+            const EmptyRectangle& r = rectangles[startRectangle];
+            for (int px = r.left; px <= r.right; px++) {
+                macro(px, r.top);
+                macro(px, r.bottom);
+            }
+            for (int py = r.top + 1; py < r.bottom; py++) {
+                macro(r.left, py);
+                macro(r.right, py);
+            }
+            continue;
+        }
+
+        // ͨھӣڲĸӣյ⣩
+        for (int d = 0; d < 8; d++) {
+            if (!CanMove(map, x, y, d)) continue;
+            const int nx = x + SEARCH_DIRECTIONS[d][0];
+            const int ny = y + SEARCH_DIRECTIONS[d][1];
+            if (IsInterior(nx, ny) && map.Index(nx, ny) != goal) continue;
+            push(cell, nx, ny, MoveCost(d));
+        }
+
+        const int id = RectangleOf(cell);
+        if (id < 0) continue;
+        const EmptyRectangle& r = rectangles[id];
+
+        // ԱΣƫƲθߣĶԱ߸
+        if (y == r.top || y == r.bottom) {
+            const int span = r.bottom - r.top;
+            const int oppositeY = y == r.top ? r.bottom : r.top;
+            for (int px = std::max(r.left, x - span); px <= std::min(r.right, x + span); px++) macro(px, oppositeY);
+        }
+        if (x == r.left || x == r.right) {
+            const int span = r.right - r.left;
+            const int oppositeX = x == r.left ? r.right : r.left;
+            for (int py = std::max(r.top, y - span); py <= std::min(r.bottom, y + span); py++) macro(oppositeX, py);
+        }
+
+        // ԽԾֻһھӸ
+        for (int d = 4; d < 8; d++) {
+            const int dx = SEARCH_DIRECTIONS[d][0];
+            const int dy = SEARCH_DIRECTIONS[d][1];
+            const int steps = std::min(dx > 0 ? r.right - x : x - r.left, dy > 0 ? r.bottom - y : y - r.top);
+            if (steps > 1) macro(x + steps * dx, y + steps * dy);
+        }
+
+        if (id == goalRectangle) macro(goalX, goalY);
+    }
+
+    if (!found) return false;
+
+    // ظڵݣÿչΪƶ
+    result.path.push_back(goal);
+    for (int cell = goal; cell != start; ) {
+        const int parent = ws.Parent(cell);
+        AppendSegment(cell % width, cell / width, parent % width, parent / width, width, result.path);
+        cell = parent;
+    }
+    std::reverse(result.path.begin(), result.path.end());
+
+    result.found = true;
+    result.cost = ws.G(goal);
+    return true;
+}
+
+std::string RectangleGraph::Serialize(const GridMap& map) const {
+    std::vector<int> bounds;
+    bounds.reserve(rectangles.size() * 4);
+    for (const EmptyRectangle& r : rectangles) {
+        bounds.push_back(r.left);
+        bounds.push_back(r.top);
+        bounds.push_back(r.right);
+        bounds.push_back(r.bottom);
+    }
+
+    ChunkWriter writer;
+    writer.WriteInt(width);
+    writer.WriteInt(height);
+    writer.WriteUInt(HashWalls(map));
+    writer.WriteInts(bounds);
+    return writer.Sealed();
+}
+
+bool RectangleGraph::Deserialize(const std::string& payload, const GridMap& map) {
+    ChunkReader reader(payload);
+    reader.Unseal();
+    int readWidth = reader.ReadInt();
+    int readHeight = reader.ReadInt();
+    uint32_t readHash = reader.ReadUInt();
+    std::vector<int> bounds;
+    reader.ReadInts(bounds);
+
+    if (!reader.AtEnd() || readWidth != map.width || readHeight != map.height || readHash != HashWalls(map) ||
+        bounds.size() % 4 != 0) {
+        return false;
+    }
+
+    // ζڵͼڡ㹻󡢻صҲǽ𻵵ļԽ
+    std::vector<EmptyRectangle> loaded;
+    std::vector<unsigned char> covered(map.CellCount(), 0);
+    for (size_t i = 0; i < bounds.size(); i += 4) {
+        const EmptyRectangle r = { bounds[i], bounds[i + 1], bounds[i + 2], bounds[i + 3] };
+        if (!map.InBounds(r.left, r.top) || !map.InBounds(r.right, r.bottom) ||
+            r.right - r.left + 1 < RECTANGLE_MIN_SIDE || r.bottom - r.top + 1 < RECTANGLE_MIN_SIDE) {
+            return false;
+        }
+        for (int y = r.top; y <= r.bottom; y++) {
+            for (int x = r.left; x <= r.right; x++) {
+                const int cell = map.Index(x, y);
+                if (map.walls[cell] || covered[cell]) return false;
+                covered[cell] = 1;
+            }
+        }
+        loaded.push_back(r);
+    }
+
+    width = readWidth;
+    height = readHeight;
+    rectangles.swap(loaded);
+    IndexRectangles();
+    return true;
+}
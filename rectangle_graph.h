@@ -0,0 +1,71 @@
+#pragma once
+
+#include "grid_map.h"
+#include "search_kernel.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// ζԳRectangular Symmetry Reduction
+// Ԥѿյ̰ķֽΪصļվΣ߶3ڲڲĸӴͼȥ
+// ߽ӳͨھ⣬дεĺߣ
+//   Ա  ԱϺƫƲθߣĸӣΪ˷
+//   ԽԾ  ָڲĶԽǷһֱߵ߽
+// ߽֮䶼ֱ߶μһߴﵽ˷룬·۲䡣
+// յھڲʱѯʱʱþεȫ߽ӡ
+// ༭ǽʱֻȥиĶӵľΣӰķΧ·ֽ
+// ֻ֧8CORNER_BLOCK_BOTH򣨿ӻߵƶ
+
+const int RECTANGLE_MIN_SIDE = 3;
+
+struct EmptyRectangle {
+    int left, top, right, bottom;   // 
+
+    bool Contains(int x, int y) const { return x >= left && x <= right && y >= top && y <= bottom; }
+    bool IsInterior(int x, int y) const { return x > left && x < right && y > top && y < bottom; }
+};
+
+class RectangleGraph {
+public:
+    RectangleGraph() : width(0), height(0) {}
+
+    // ԵͼԤ
+    void Build(const GridMap& map);
+
+    // һӣǽ״̬ı
+    void SetWalls(const GridMap& map, const std::vector<int>& cells);
+
+    bool IsBuiltFor(const GridMap& map) const {
+        return width == map.width && height == map.height && rectangleOfCell.size() == static_cast<size_t>(map.CellCount());
+    }
+
+    // ѯ·result.pathΪԭʼͼ
+    bool FindPath(const GridMap& map, int startX, int startY, int goalX, int goalY,
+        SearchWorkspace& workspace, SearchResult& result) const;
+
+    // лΪͼļչݣ¼ǽУֵʱͼԤһ»򷵻false
+    std::string Serialize(const GridMap& map) const;
+    bool Deserialize(const std::string& payload, const GridMap& map);
+
+    const std::vector<EmptyRectangle>& Rectangles() const { return rectangles; }
+    // ȥڲ
+    size_t PrunedCount() const;
+
+private:
+    // ÿδռõĿոʼ̰ķֽ⣬¾ο쵽֮δռÿո
+    void Decompose(const GridMap& map, int left, int top, int right, int bottom);
+    void AddRectangle(const EmptyRectangle& rectangle);
+    void IndexRectangles();
+    // ھεıţκξʱΪ-1
+    int RectangleOf(int cell) const { return rectangleOfCell[cell]; }
+    bool IsInterior(int x, int y) const {
+        const int id = rectangleOfCell[y * width + x];
+        return id >= 0 && rectangles[id].IsInterior(x, y);
+    }
+
+    int width;
+    int height;
+    std::vector<EmptyRectangle> rectangles;
+    std::vector<int> rectangleOfCell;   // 
+};
@@ -0,0 +1,127 @@
+#include "reference_search.h"
+
+#include <queue>
+#include <vector>
+#include <algorithm>
+
+namespace {
+
+// ڵṹ
+struct Node {
+    int x, y;
+    int g, h, f;
+    Node* parent;
+
+    Node(int x, int y) : x(x), y(y), g(0), h(0), f(0), parent(nullptr) {}
+};
+
+// ڵȽϺ
+struct NodeCompare {
+    bool operator()(Node* a, Node* b) const {
+        return a->f > b->f;
+    }
+};
+
+// ʽ루پ룩
+int CalculateHeuristic(int x1, int y1, int x2, int y2) {
+    return abs(x1 - x2) + abs(y1 - y2);
+}
+
+} // namespace
+
+bool RunReferenceSearch(const GridMap& map, int startX, int startY, int goalX, int goalY, SearchResult& result) {
+    result = SearchResult();
+    if (map.IsWall(startX, startY) || map.IsWall(goalX, goalY)) return false;
+
+    std::priority_queue<Node*, std::vector<Node*>, NodeCompare> openSet;
+    std::vector<unsigned char> closedSet(map.CellCount(), 0);
+    std::vector<Node*> allNodes;  // ԭʵֲͷѹرսڵ㣬ͳһ¼ͷ
+
+    Node* startNode = new Node(startX, startY);
+    startNode->h = CalculateHeuristic(startX, startY, goalX, goalY);
+    startNode->f = startNode->h;
+    openSet.push(startNode);
+    allNodes.push_back(startNode);
+
+    while (!openSet.empty()) {
+        Node* current = openSet.top();
+        openSet.pop();
+
+        if (current->x == goalX && current->y == goalY) {
+            // ҵ·
+            result.found = true;
+            result.cost = current->g;
+            for (Node* pathNode = current; pathNode != nullptr; pathNode = pathNode->parent) {
+                result.path.push_back(map.Index(pathNode->x, pathNode->y));
+            }
+            std::reverse(result.path.begin(), result.path.end());
+            break;
+        }
+
+        closedSet[map.Index(current->x, current->y)] = 1;
+        result.expanded++;
+
+        for (int i = 0; i < 8; i++) {
+            int newX = current->x + SEARCH_DIRECTIONS[i][0];
+            int newY = current->y + SEARCH_DIRECTIONS[i][1];
+
+            if (!map.InBounds(newX, newY))
+                continue;
+
+            if (map.IsWall(newX, newY) || closedSet[map.Index(newX, newY)])
+                continue;
+
+            // ԽƶǷֱǽ赲
+            if (i >= 4) {
+                if (map.IsWall(current->x + SEARCH_DIRECTIONS[i][0], current->y) &&
+                    map.IsWall(current->x, current->y + SEARCH_DIRECTIONS[i][1])) {
+                    continue;
+                }
+            }
+
+            int newG = current->g + ((i < 4) ? COST_STRAIGHT : COST_DIAGONAL);
+
+            // ǷѾڿб
+            bool inOpenSet = false;
+            std::vector<Node*> tempNodes;
+
+            // ʱ洢
+            while (!openSet.empty()) {
+                Node* node = openSet.top();
+                openSet.pop();
+                tempNodes.push_back(node);
+
+                if (node->x == newX && node->y == newY) {
+                    inOpenSet = true;
+                    if (newG < node->g) {
+                        node->g = newG;
+                        node->f = node->g + node->h;
+                        node->parent = current;
+                    }
+                    break;
+                }
+            }
+
+            // ָȶ
+            for (size_t j = 0; j < tempNodes.size(); j++) {
+                openSet.push(tempNodes[j]);
+            }
+
+            if (!inOpenSet) {
+                Node* neighbor = new Node(newX, newY);
+                neighbor->g = newG;
+                neighbor->h = CalculateHeuristic(newX, newY, goalX, goalY);
+                neighbor->f = neighbor->g + neighbor->h;
+                neighbor->parent = current;
+                openSet.push(neighbor);
+                allNodes.push_back(neighbor);
+            }
+        }
+    }
+
+    // ڴ
+    for (size_t i = 0; i < allNodes.size(); i++) {
+        delete allNodes[i];
+    }
+    return result.found;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "grid_map.h"
+
+// οӻеA*ʵ֣ʽȡٷŻصĿбң
+// ȥ̺߳ԭΪȷԻ׼
+// ֻ֧8CORNER_BLOCK_BOTH
+bool RunReferenceSearch(const GridMap& map, int startX, int startY, int goalX, int goalY, SearchResult& result);
@@ -0,0 +1,65 @@
+#include "search_kernel.h"
+
+#include <algorithm>
+
+// ֱͨǽѡںˣ4ʱֱǽ壩
+template<int Stride, typename CostT>
+static bool RunWithStride(const PaddedGrid& grid, int start, int goal, const SearchOptions& options,
+    SearchWorkspace& workspace, size_t& expanded) {
+    if (options.connectivity == 4) {
+        return GridSearchKernel<Stride, 4, CORNER_BLOCK_BOTH, CostT>::Run(grid, start, goal, workspace, expanded);
+    }
+    if (options.cornerRule == CORNER_BLOCK_BOTH) {
+        return GridSearchKernel<Stride, 8, CORNER_BLOCK_BOTH, CostT>::Run(grid, start, goal, workspace, expanded);
+    }
+    return GridSearchKernel<Stride, 8, CORNER_BLOCK_ANY, CostT>::Run(grid, start, goal, workspace, expanded);
+}
+
+bool RunGridSearch(const PaddedGrid& grid, int startX, int startY, int goalX, int goalY,
+    const SearchOptions& options, SearchWorkspace& workspace, SearchResult& result) {
+    result.found = false;
+    result.cost = 0;
+    result.path.clear();
+    result.expanded = 0;
+
+    if (startX < 0 || startX >= grid.width || startY < 0 || startY >= grid.height ||
+        goalX < 0 || goalX >= grid.width || goalY < 0 || goalY >= grid.height) {
+        return false;
+    }
+
+    const int start = grid.ToPadded(startX, startY);
+    const int goal = grid.ToPadded(goalX, goalY);
+    if (grid.walls[start] || grid.walls[goal]) return false;
+
+    // ·ϽܷŽ16λʱʹøյĿбԪ
+    const long long maxCost = static_cast<long long>(grid.width) * grid.height * COST_DIAGONAL * 2;
+    const bool smallCost = maxCost < 0xFFFF;
+
+    bool found;
+    switch (grid.stride) {
+    case 64:
+        found = smallCost ? RunWithStride<64, unsigned short>(grid, start, goal, options, workspace, result.expanded)
+            : RunWithStride<64, int>(grid, start, goal, options, workspace, result.expanded);
+        break;
+    case 128:  found = RunWithStride<128, int>(grid, start, goal, options, workspace, result.expanded); break;
+    case 256:  found = RunWithStride<256, int>(grid, start, goal, options, workspace, result.expanded); break;
+    case 512:  found = RunWithStride<512, int>(grid, start, goal, options, workspace, result.expanded); break;
+    case 1024: found = RunWithStride<1024, int>(grid, start, goal, options, workspace, result.expanded); break;
+    case 2048: found = RunWithStride<2048, int>(grid, start, goal, options, workspace, result.expanded); break;
+    case 4096: found = RunWithStride<4096, int>(grid, start, goal, options, workspace, result.expanded); break;
+    default:   found = RunWithStride<0, int>(grid, start, goal, options, workspace, result.expanded); break;
+    }
+
+    if (!found) return false;
+
+    // ظڵ·
+    for (int p = goal; p != -1; p = workspace.Parent(p)) {
+        result.path.push_back(grid.ToMapIndex(p));
+        if (p == start) break;
+    }
+    std::reverse(result.path.begin(), result.path.end());
+
+    result.found = true;
+    result.cost = workspace.G(goal);
+    return true;
+}
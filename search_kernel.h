@@ -0,0 +1,212 @@
+#pragma once
+
+#include "grid_map.h"
+#include "search_profiler.h"
+
+#include <vector>
+#include <utility>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+
+// ǽ߿ĵͼпȡ2ݣܸһȦǽչھʱԽ
+struct PaddedGrid {
+    int width = 0;      // ԭʼͼ
+    int height = 0;     // ԭʼͼ߶
+    int stride = 0;     // пȣ2ݣΪwidth + 2
+    int shift = 0;      // log2(stride)
+    std::vector<unsigned char> walls;  // (height + 2) * stride1ʾǽ
+
+    void Build(const GridMap& map) {
+        width = map.width;
+        height = map.height;
+        shift = 0;
+        while ((1 << shift) < width + 2) shift++;
+        stride = 1 << shift;
+        walls.assign(static_cast<size_t>(height + 2) * stride, 1);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                walls[ToPadded(x, y)] = map.walls[map.Index(x, y)];
+            }
+        }
+    }
+
+    void SetWall(int x, int y, bool wall) {
+        walls[ToPadded(x, y)] = wall ? 1 : 0;
+    }
+
+    int CellCount() const { return static_cast<int>(walls.size()); }
+    int ToPadded(int x, int y) const { return ((y + 1) << shift) + (x + 1); }
+    int PaddedX(int p) const { return (p & (stride - 1)) - 1; }
+    int PaddedY(int p) const { return (p >> shift) - 1; }
+    int ToMapIndex(int p) const { return PaddedY(p) * width + PaddedX(p); }
+};
+
+// бԪأfСȣfͬʱgȣյ㣩
+// std::push_heap / std::pop_heapĴ󶥶ԼСԪȼ
+template<typename CostT>
+struct GridOpenEntry {
+    CostT f;
+    CostT g;
+    int cell;
+
+    bool operator<(const GridOpenEntry& other) const {
+        return f > other.f || (f == other.f && g < other.g);
+    }
+};
+
+// ʹõʱݣڶβѯ֮临
+// ÿβѯĸΪδʣ谴ͼС㣻
+// бĴ洢Ҳ֮ѯٷڴ
+struct SearchWorkspace {
+    std::vector<unsigned int> stamp;   // ( << 1) | Ƿѹر
+    std::vector<int> g;
+    std::vector<int> parent;
+    unsigned int generation = 0;
+    std::vector<GridOpenEntry<int> > openInt;
+    std::vector<GridOpenEntry<unsigned short> > openShort;
+    ProfileCounters* profile = nullptr;   // ǿʱ¼ÿչӴsearch_profiler.h
+
+    // ȡб洢÷clear
+    template<typename CostT>
+    std::vector<GridOpenEntry<CostT> >& OpenStorage();
+
+    // ʼµĲѯ
+    void Begin(int cellCount) {
+        if (static_cast<int>(stamp.size()) < cellCount) {
+            stamp.resize(cellCount, 0);
+            g.resize(cellCount);
+            parent.resize(cellCount);
+        }
+        generation++;
+        // ʱһ
+        if (generation >= (1u << 31)) {
+            std::fill(stamp.begin(), stamp.end(), 0u);
+            generation = 1;
+        }
+    }
+
+    bool IsVisited(int cell) const { return (stamp[cell] >> 1) == generation; }
+    bool IsClosed(int cell) const { return stamp[cell] == ((generation << 1) | 1u); }
+    int G(int cell) const { return IsVisited(cell) ? g[cell] : std::numeric_limits<int>::max(); }
+    int Parent(int cell) const { return IsVisited(cell) ? parent[cell] : -1; }
+
+    void Open(int cell, int cost, int from) {
+        stamp[cell] = generation << 1;
+        g[cell] = cost;
+        parent[cell] = from;
+    }
+
+    void Close(int cell) { stamp[cell] |= 1u; }
+};
+
+template<>
+inline std::vector<GridOpenEntry<int> >& SearchWorkspace::OpenStorage<int>() { return openInt; }
+
+template<>
+inline std::vector<GridOpenEntry<unsigned short> >& SearchWorkspace::OpenStorage<unsigned short>() { return openShort; }
+
+// ģ廯ںˣпȡͨԡֱǽʹڱȷ
+// StrideΪ0ʱʹʱgrid.stride
+template<int Stride, int Connectivity, CornerRule Rule, typename CostT>
+class GridSearchKernel {
+    static_assert(Connectivity == 4 || Connectivity == 8, "Connectivity must be 4 or 8");
+    static_assert(Stride == 0 || (Stride & (Stride - 1)) == 0, "Stride must be a power of two");
+
+    typedef GridOpenEntry<CostT> OpenEntry;
+    typedef std::vector<OpenEntry> OpenList;   // ѣ洢SearchWorkspace
+
+    // iӦƫƣSEARCH_DIRECTIONS˳һ£
+    template<int I>
+    static constexpr int Offset(int stride) {
+        return SEARCH_DIRECTIONS[I][1] * stride + SEARCH_DIRECTIONS[I][0];
+    }
+
+    static int Heuristic(int dx, int dy) {
+        if (dx < 0) dx = -dx;
+        if (dy < 0) dy = -dy;
+        if (Connectivity == 4) return COST_STRAIGHT * (dx + dy);
+        return dx > dy ? COST_STRAIGHT * dx + (COST_DIAGONAL - COST_STRAIGHT) * dy
+            : COST_STRAIGHT * dy + (COST_DIAGONAL - COST_STRAIGHT) * dx;
+    }
+
+    // ɳڷIϵھ
+    template<int I>
+    static void Relax(const unsigned char* walls, int stride, int shift, int current, int currentG,
+        int goalX, int goalY, SearchWorkspace& ws, OpenList& openSet) {
+        const int offset = Offset<I>(stride);
+        const int next = current + offset;
+        if (walls[next] || ws.IsClosed(next)) return;
+
+        if (I >= 4) {
+            const bool wallX = walls[current + SEARCH_DIRECTIONS[I][0]] != 0;
+            const bool wallY = walls[current + SEARCH_DIRECTIONS[I][1] * stride] != 0;
+            if (Rule == CORNER_BLOCK_BOTH ? (wallX && wallY) : (wallX || wallY)) return;
+        }
+
+        const int newG = currentG + (I < 4 ? COST_STRAIGHT : COST_DIAGONAL);
+        if (newG >= ws.G(next)) return;
+
+        ws.Open(next, newG, current);
+        const int h = Heuristic((next & (stride - 1)) - goalX, (next >> shift) - goalY);
+        openSet.push_back({ static_cast<CostT>(newG + h), static_cast<CostT>(newG), next });
+        std::push_heap(openSet.begin(), openSet.end());
+        SEARCH_PROFILE_PUSH(ws, (next & (stride - 1)) - 1, (next >> shift) - 1);
+    }
+
+    template<std::size_t... I>
+    static void RelaxAll(std::index_sequence<I...>, const unsigned char* walls, int stride, int shift,
+        int current, int currentG, int goalX, int goalY, SearchWorkspace& ws, OpenList& openSet) {
+        (Relax<static_cast<int>(I)>(walls, stride, shift, current, currentG, goalX, goalY, ws, openSet), ...);
+    }
+
+public:
+    // ڴ߿ͼϴstartgoalΪ߿
+    // ɹʱtrue·ͨws.Parent
+    static bool Run(const PaddedGrid& grid, int start, int goal, SearchWorkspace& ws, size_t& expanded) {
+        const int stride = Stride > 0 ? Stride : grid.stride;
+        const int shift = Stride > 0 ? Log2(Stride) : grid.shift;
+        const unsigned char* walls = grid.walls.data();
+        const int goalX = goal & (stride - 1);
+        const int goalY = goal >> shift;
+
+        ws.Begin(grid.CellCount());
+        expanded = 0;
+
+        OpenList& openSet = ws.OpenStorage<CostT>();
+        openSet.clear();
+        ws.Open(start, 0, -1);
+        openSet.push_back({ static_cast<CostT>(Heuristic((start & (stride - 1)) - goalX, (start >> shift) - goalY)),
+            static_cast<CostT>(0), start });
+        SEARCH_PROFILE_PUSH(ws, grid.PaddedX(start), grid.PaddedY(start));
+
+        while (!openSet.empty()) {
+            std::pop_heap(openSet.begin(), openSet.end());
+            OpenEntry top = openSet.back();
+            openSet.pop_back();
+
+            const int current = top.cell;
+            if (ws.IsClosed(current)) continue;
+            ws.Close(current);
+            expanded++;
+            SEARCH_PROFILE_EXPAND(ws, grid.PaddedX(current), grid.PaddedY(current));
+
+            if (current == goal) return true;
+
+            const int currentG = ws.g[current];
+            RelaxAll(std::make_index_sequence<Connectivity>(), walls, stride, shift,
+                current, currentG, goalX, goalY, ws, openSet);
+        }
+        return false;
+    }
+
+private:
+    static constexpr int Log2(int value) {
+        return value <= 1 ? 0 : 1 + Log2(value >> 1);
+    }
+};
+
+// ʱַݵͼпȡֱͨǽѡػ汾
+// ɹʱresult.pathΪԭʼͼϵy * width + x
+bool RunGridSearch(const PaddedGrid& grid, int startX, int startY, int goalX, int goalY,
+    const SearchOptions& options, SearchWorkspace& workspace, SearchResult& result);
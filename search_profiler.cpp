@@ -0,0 +1,146 @@
+#include "search_profiler.h"
+
+#include <fstream>
+#include <cmath>
+
+namespace {
+
+void PutLE(std::string& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) out += static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+// ȶ01ӳ䵽ɫ ->  ->  -> 
+void HeatColor(double t, unsigned char rgb[3]) {
+    static const double STOPS[4][3] = { { 20, 20, 120 }, { 200, 30, 30 }, { 255, 210, 0 }, { 255, 255, 255 } };
+    const double scaled = std::min(std::max(t, 0.0), 1.0) * 3.0;
+    const int index = std::min(static_cast<int>(scaled), 2);
+    const double frac = scaled - index;
+    for (int c = 0; c < 3; c++) {
+        rgb[c] = static_cast<unsigned char>(STOPS[index][c] + (STOPS[index + 1][c] - STOPS[index][c]) * frac + 0.5);
+    }
+}
+
+} // namespace
+
+void ProfileCounters::Reset(int mapWidth, int mapHeight) {
+    width = mapWidth;
+    height = mapHeight;
+    queries = 0;
+    expanded.assign(static_cast<size_t>(width) * height, 0);
+    pushed.assign(static_cast<size_t>(width) * height, 0);
+}
+
+void ProfileCounters::Add(const ProfileCounters& other) {
+    if (other.width != width || other.height != height) return;
+    queries += other.queries;
+    for (size_t i = 0; i < expanded.size(); i++) {
+        expanded[i] += other.expanded[i];
+        pushed[i] += other.pushed[i];
+    }
+}
+
+ProfileCounters* SearchProfiler::AddThread() {
+    std::unique_ptr<ProfileCounters> counters(new ProfileCounters());
+    counters->Reset(width, height);
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.push_back(std::move(counters));
+    return threads.back().get();
+}
+
+void SearchProfiler::Merge(ProfileCounters& total) const {
+    total.Reset(width, height);
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < threads.size(); i++) total.Add(*threads[i]);
+}
+
+bool WriteProfileCsv(const std::string& file, const ProfileCounters& counters, ProfileCounter counter) {
+    std::ofstream output(file, std::ios::binary);
+    if (!output) return false;
+    const std::vector<uint32_t>& counts = counters.Counts(counter);
+    std::string line;
+    for (int y = 0; y < counters.height; y++) {
+        line.clear();
+        for (int x = 0; x < counters.width; x++) {
+            if (x > 0) line += ',';
+            line += std::to_string(counts[y * counters.width + x]);
+        }
+        line += '\n';
+        output << line;
+    }
+    return static_cast<bool>(output);
+}
+
+bool WriteProfileBinary(const std::string& file, const ProfileCounters& counters) {
+    std::ofstream output(file, std::ios::binary);
+    if (!output) return false;
+    std::string header("HEAT");
+    PutLE(header, static_cast<uint32_t>(counters.width), 4);
+    PutLE(header, static_cast<uint32_t>(counters.height), 4);
+    PutLE(header, static_cast<uint32_t>(counters.queries), 4);
+    PutLE(header, static_cast<uint32_t>(counters.queries >> 32), 4);
+    output.write(header.data(), header.size());
+    output.write(reinterpret_cast<const char*>(counters.expanded.data()), counters.expanded.size() * sizeof(uint32_t));
+    output.write(reinterpret_cast<const char*>(counters.pushed.data()), counters.pushed.size() * sizeof(uint32_t));
+    return static_cast<bool>(output);
+}
+
+bool WriteProfileHeatmap(const std::string& file, const ProfileCounters& counters, ProfileCounter counter,
+    const GridMap* map, int cellPixels) {
+    if (cellPixels < 1) cellPixels = 1;
+    if (map && (map->width != counters.width || map->height != counters.height)) map = nullptr;
+
+    const std::vector<uint32_t>& counts = counters.Counts(counter);
+    uint32_t peak = 0;
+    for (uint32_t value : counts) peak = std::max(peak, value);
+    const double scale = peak > 0 ? 1.0 / std::log1p(static_cast<double>(peak)) : 0.0;
+
+    const int imageWidth = counters.width * cellPixels;
+    const int imageHeight = counters.height * cellPixels;
+    const int rowBytes = (imageWidth * 3 + 3) & ~3;
+    const uint32_t pixelBytes = static_cast<uint32_t>(rowBytes) * imageHeight;
+
+    std::string image;
+    image.reserve(54 + pixelBytes);
+    image += "BM";
+    PutLE(image, 54 + pixelBytes, 4);
+    PutLE(image, 0, 4);
+    PutLE(image, 54, 4);
+    PutLE(image, 40, 4);
+    PutLE(image, static_cast<uint32_t>(imageWidth), 4);
+    PutLE(image, static_cast<uint32_t>(imageHeight), 4);
+    PutLE(image, 1, 2);
+    PutLE(image, 24, 2);
+    PutLE(image, 0, 4);
+    PutLE(image, pixelBytes, 4);
+    PutLE(image, 2835, 4);
+    PutLE(image, 2835, 4);
+    PutLE(image, 0, 4);
+    PutLE(image, 0, 4);
+
+    // BMPµϵ˳洢УÿΪBGR
+    std::string row(rowBytes, '\0');
+    for (int y = counters.height - 1; y >= 0; y--) {
+        for (int x = 0; x < counters.width; x++) {
+            const int cell = y * counters.width + x;
+            unsigned char rgb[3] = { 0, 0, 0 };
+            if (map && map->walls[cell]) {
+                rgb[0] = rgb[1] = rgb[2] = 96;
+            }
+            else if (counts[cell] > 0) {
+                HeatColor(std::log1p(static_cast<double>(counts[cell])) * scale, rgb);
+            }
+            for (int p = 0; p < cellPixels; p++) {
+                char* pixel = &row[(x * cellPixels + p) * 3];
+                pixel[0] = static_cast<char>(rgb[2]);
+                pixel[1] = static_cast<char>(rgb[1]);
+                pixel[2] = static_cast<char>(rgb[0]);
+            }
+        }
+        for (int p = 0; p < cellPixels; p++) image += row;
+    }
+
+    std::ofstream output(file, std::ios::binary);
+    if (!output) return false;
+    output.write(image.data(), image.size());
+    return static_cast<bool>(output);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "grid_map.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+// չȶͳƣڴѯۼÿӱչͱ뿪бĴж
+// ͨSearchWorkspace::profileȡǰ̵߳ļΪʱͳƣÿչֻһпգ
+// ʱSEARCH_PROFILER_ENABLEDΪ0԰ͳƴȥ
+// ÿ߳дԼһݼֹͣͳʱٺϲ·ûԭӲ
+
+#ifndef SEARCH_PROFILER_ENABLED
+#define SEARCH_PROFILER_ENABLED 1
+#endif
+
+#if SEARCH_PROFILER_ENABLED
+#define SEARCH_PROFILE_EXPAND(ws, x, y) do { if ((ws).profile) (ws).profile->AddExpand((x), (y)); } while (0)
+#define SEARCH_PROFILE_PUSH(ws, x, y) do { if ((ws).profile) (ws).profile->AddPush((x), (y)); } while (0)
+#else
+#define SEARCH_PROFILE_EXPAND(ws, x, y) ((void)0)
+#define SEARCH_PROFILE_PUSH(ws, x, y) ((void)0)
+#endif
+
+enum ProfileCounter {
+    PROFILE_EXPANDED,       // չ
+    PROFILE_PUSHED          // 뿪бĴ
+};
+
+// һ̵߳ļԭʼͼ洢
+struct ProfileCounters {
+    int width = 0;
+    int height = 0;
+    uint64_t queries = 0;
+    std::vector<uint32_t> expanded;
+    std::vector<uint32_t> pushed;
+
+    void Reset(int mapWidth, int mapHeight);
+    // ۼӳߴͬһݼ
+    void Add(const ProfileCounters& other);
+
+    void AddExpand(int x, int y) { expanded[y * width + x]++; }
+    void AddPush(int x, int y) { pushed[y * width + x]++; }
+
+    const std::vector<uint32_t>& Counts(ProfileCounter counter) const {
+        return counter == PROFILE_EXPANDED ? expanded : pushed;
+    }
+};
+
+// һͳƣΪÿ̵߳Ǽһݼʱϲ
+class SearchProfiler {
+public:
+    SearchProfiler(int mapWidth, int mapHeight) : width(mapWidth), height(mapHeight) {}
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+
+    // Ϊ̵߳ǼһݼָSearchProfilerǰЧֻӦɸ߳д
+    ProfileCounters* AddThread();
+
+    // ϲ̵߳ļʱ߳д
+    void Merge(ProfileCounters& total) const;
+
+private:
+    int width;
+    int height;
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<ProfileCounters> > threads;
+};
+
+// ϲļ
+// CSVÿжӦͼһУŷָĳһּ
+bool WriteProfileCsv(const std::string& file, const ProfileCounters& counters, ProfileCounter counter);
+// ƣ"HEAT"ǡߣ32λѯ64λǰд洢չӴ32λ
+bool WriteProfileBinary(const std::string& file, const ProfileCounters& counters);
+// 24λBMPȶͼ̶ȴ졢ƵɫδʵĿոΪɫmapǿʱǽɻɫ
+// ÿӻcellPixels x cellPixelsķ
+bool WriteProfileHeatmap(const std::string& file, const ProfileCounters& counters, ProfileCounter counter,
+    const GridMap* map, int cellPixels);
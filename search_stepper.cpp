@@ -0,0 +1,135 @@
+#include "search_stepper.h"
+
+#include <algorithm>
+
+namespace {
+
+// fСȣfͬʱg
+struct StepperCompare {
+    template<typename Entry>
+    bool operator()(const Entry& a, const Entry& b) const {
+        return a.f > b.f || (a.f == b.f && a.g < b.g);
+    }
+};
+
+} // namespace
+
+void SearchStepper::Start(const PaddedGrid& searchGrid, int startX, int startY, int goalX, int goalY,
+    const SearchOptions& searchOptions) {
+    grid = &searchGrid;
+    options = searchOptions;
+    expanded = 0;
+    nodes.clear();
+    openList.clear();
+
+    if (startX < 0 || startX >= grid->width || startY < 0 || startY >= grid->height ||
+        goalX < 0 || goalX >= grid->width || goalY < 0 || goalY >= grid->height) {
+        status = SEARCH_NOT_FOUND;
+        return;
+    }
+
+    start = grid->ToPadded(startX, startY);
+    goal = grid->ToPadded(goalX, goalY);
+    if (grid->walls[start] || grid->walls[goal]) {
+        status = SEARCH_NOT_FOUND;
+        return;
+    }
+
+    nodes[start] = { 0, -1, false };
+    openList.push_back({ Heuristic(start), 0, start });
+    status = SEARCH_RUNNING;
+}
+
+int SearchStepper::Heuristic(int cell) const {
+    int dx = abs((cell & (grid->stride - 1)) - (goal & (grid->stride - 1)));
+    int dy = abs((cell >> grid->shift) - (goal >> grid->shift));
+    if (options.connectivity == 4) return COST_STRAIGHT * (dx + dy);
+    return COST_STRAIGHT * std::max(dx, dy) + (COST_DIAGONAL - COST_STRAIGHT) * std::min(dx, dy);
+}
+
+SearchStatus SearchStepper::Step(size_t maxExpansions, std::vector<SearchEvent>* events) {
+    if (status != SEARCH_RUNNING) return status;
+
+    const int stride = grid->stride;
+    const int connectivity = options.connectivity == 4 ? 4 : 8;
+    const unsigned char* walls = grid->walls.data();
+    StepperCompare compare;
+    size_t done = 0;
+
+    while (done < maxExpansions) {
+        if (openList.empty()) {
+            status = SEARCH_NOT_FOUND;
+            return status;
+        }
+
+        std::pop_heap(openList.begin(), openList.end(), compare);
+        OpenEntry entry = openList.back();
+        openList.pop_back();
+
+        NodeState& node = nodes[entry.cell];
+        if (node.closed || entry.g != node.g) continue;
+
+        const int current = entry.cell;
+        if (current == goal) {
+            status = SEARCH_FOUND;
+            return status;
+        }
+
+        node.closed = true;
+        expanded++;
+        done++;
+        if (events) events->push_back({ SEARCH_EVENT_EXPAND, grid->ToMapIndex(current) });
+
+        for (int i = 0; i < connectivity; i++) {
+            const int next = current + SEARCH_DIRECTIONS[i][1] * stride + SEARCH_DIRECTIONS[i][0];
+            if (walls[next]) continue;
+
+            // ԽƶǷֱǽ赲
+            if (i >= 4) {
+                const bool wallX = walls[current + SEARCH_DIRECTIONS[i][0]] != 0;
+                const bool wallY = walls[current + SEARCH_DIRECTIONS[i][1] * stride] != 0;
+                if (options.cornerRule == CORNER_BLOCK_BOTH ? (wallX && wallY) : (wallX || wallY)) continue;
+            }
+
+            const int newG = entry.g + MoveCost(i);
+            auto found = nodes.find(next);
+            if (found != nodes.end()) {
+                if (found->second.closed || newG >= found->second.g) continue;
+                found->second.g = newG;
+                found->second.parent = current;
+            }
+            else {
+                nodes.emplace(next, NodeState{ newG, current, false });
+                if (events) events->push_back({ SEARCH_EVENT_OPEN, grid->ToMapIndex(next) });
+            }
+
+            openList.push_back({ newG + Heuristic(next), newG, next });
+            std::push_heap(openList.begin(), openList.end(), compare);
+        }
+    }
+    return status;
+}
+
+SearchStatus SearchStepper::RunUntil(std::chrono::steady_clock::time_point deadline, std::vector<SearchEvent>* events) {
+    // ƽÿ֮һʱ
+    while (Step(64, events) == SEARCH_RUNNING) {
+        if (std::chrono::steady_clock::now() >= deadline) break;
+    }
+    return status;
+}
+
+int SearchStepper::Cost() const {
+    if (status != SEARCH_FOUND) return -1;
+    return nodes.find(goal)->second.g;
+}
+
+bool SearchStepper::GetPath(std::vector<int>& path) const {
+    path.clear();
+    if (status != SEARCH_FOUND) return false;
+
+    for (int p = goal; p != -1; p = nodes.find(p)->second.parent) {
+        path.push_back(grid->ToMapIndex(p));
+    }
+    std::reverse(path.begin(), path.end());
+    return true;
+}
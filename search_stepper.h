@@ -0,0 +1,74 @@
+#pragma once
+
+#include "search_kernel.h"
+
+#include <vector>
+#include <chrono>
+#include <unordered_map>
+
+// ɻָķֲA*ɵ÷ÿչɽڵ󷵻أҪ߳
+// ڵ״̬ڹϣУڴʵʷʵĸȣ
+// ͬһ߳̿Խƽ
+
+enum SearchEventType {
+    SEARCH_EVENT_OPEN = 0,      // ڵ뿪б
+    SEARCH_EVENT_EXPAND = 1     // ڵ㱻չرб
+};
+
+struct SearchEvent {
+    SearchEventType type;
+    int cell;                   // ԭʼͼϵy * width + x
+};
+
+enum SearchStatus {
+    SEARCH_IDLE = 0,
+    SEARCH_RUNNING = 1,
+    SEARCH_FOUND = 2,
+    SEARCH_NOT_FOUND = 3
+};
+
+class SearchStepper {
+public:
+    SearchStepper() : grid(nullptr), start(-1), goal(-1), status(SEARCH_IDLE), expanded(0) {}
+
+    // ʼµgridڼ䱣Ч
+    void Start(const PaddedGrid& grid, int startX, int startY, int goalX, int goalY,
+        const SearchOptions& options = SearchOptions());
+
+    // չmaxExpansionsڵ㣻eventsΪʱ׷ӱβ¼
+    SearchStatus Step(size_t maxExpansions, std::vector<SearchEvent>* events = nullptr);
+
+    // չֱ򵽴ֹʱ
+    SearchStatus RunUntil(std::chrono::steady_clock::time_point deadline, std::vector<SearchEvent>* events = nullptr);
+
+    SearchStatus Status() const { return status; }
+    size_t Expanded() const { return expanded; }
+    int Cost() const;
+
+    // ҵ·ȡ·ԭʼͼ㵽յ㣩
+    bool GetPath(std::vector<int>& path) const;
+
+private:
+    struct NodeState {
+        int g;
+        int parent;
+        bool closed;
+    };
+
+    struct OpenEntry {
+        int f;
+        int g;
+        int cell;
+    };
+
+    int Heuristic(int cell) const;
+
+    const PaddedGrid* grid;
+    SearchOptions options;
+    int start;
+    int goal;
+    SearchStatus status;
+    size_t expanded;
+    std::unordered_map<int, NodeState> nodes;
+    std::vector<OpenEntry> openList;
+};
@@ -0,0 +1,385 @@
+#include "subgoal_graph.h"
+#include "map_file.h"
+
+#include <queue>
+#include <algorithm>
+
+namespace {
+
+// SEARCH_DIRECTIONSеı
+int DirectionIndex(int dx, int dy) {
+    for (int d = 0; d < 8; d++) {
+        if (SEARCH_DIRECTIONS[d][0] == dx && SEARCH_DIRECTIONS[d][1] == dy) return d;
+    }
+    return -1;
+}
+
+int Sign(int value) {
+    return value > 0 ? 1 : (value < 0 ? -1 : 0);
+}
+
+// Ŀ꣺ܳΪ·յĸӣϰԵĿո
+// ȡģʽĲĿ겻Ӱȷԣ
+//   бڸǽֱڸ񶼿գƹ͹ǣ
+//   ֱڸǽһֱڸбڸ񶼿գнʱǽת
+bool IsSubgoal(const GridMap& map, int x, int y) {
+    if (map.IsWall(x, y)) return false;
+    for (int d = 4; d < 8; d++) {
+        int dx = SEARCH_DIRECTIONS[d][0];
+        int dy = SEARCH_DIRECTIONS[d][1];
+        bool wallDiagonal = map.IsWall(x + dx, y + dy);
+        bool wallX = map.IsWall(x + dx, y);
+        bool wallY = map.IsWall(x, y + dy);
+        if (wallDiagonal && !wallX && !wallY) return true;
+        if (wallX && !wallY && !wallDiagonal) return true;
+        if (wallY && !wallX && !wallDiagonal) return true;
+    }
+    return false;
+}
+
+// hɴ·ֻһԽǷһֱ߷ɣ
+// ضԽij(i, j)̬滮жϿɴﲢ·
+struct MonotoneMoves {
+    int diagonalDir;    // ԽǷյͬлͬʱΪ-1
+    int straightDir;    // ֱ߷㹹ԽʱΪ-1
+    int diagonalSteps;
+    int straightSteps;
+};
+
+MonotoneMoves GetMonotoneMoves(int fromX, int fromY, int toX, int toY) {
+    int dx = toX - fromX;
+    int dy = toY - fromY;
+    int adx = abs(dx), ady = abs(dy);
+
+    MonotoneMoves moves;
+    moves.diagonalSteps = std::min(adx, ady);
+    moves.straightSteps = std::max(adx, ady) - moves.diagonalSteps;
+    moves.diagonalDir = moves.diagonalSteps > 0 ? DirectionIndex(Sign(dx), Sign(dy)) : -1;
+    moves.straightDir = moves.straightSteps == 0 ? -1
+        : (adx > ady ? DirectionIndex(Sign(dx), 0) : DirectionIndex(0, Sign(dy)));
+    return moves;
+}
+
+// (i, j)ϼصƶĿɴԣreachi * (straightSteps + 1) + j洢
+bool ComputeMonotoneReach(const GridMap& map, int fromX, int fromY, const MonotoneMoves& moves,
+    std::vector<unsigned char>& reach) {
+    const int columns = moves.straightSteps + 1;
+    reach.assign(static_cast<size_t>(moves.diagonalSteps + 1) * columns, 0);
+
+    const int ddx = moves.diagonalDir >= 0 ? SEARCH_DIRECTIONS[moves.diagonalDir][0] : 0;
+    const int ddy = moves.diagonalDir >= 0 ? SEARCH_DIRECTIONS[moves.diagonalDir][1] : 0;
+    const int sdx = moves.straightDir >= 0 ? SEARCH_DIRECTIONS[moves.straightDir][0] : 0;
+    const int sdy = moves.straightDir >= 0 ? SEARCH_DIRECTIONS[moves.straightDir][1] : 0;
+
+    reach[0] = 1;
+    for (int i = 0; i <= moves.diagonalSteps; i++) {
+        for (int j = 0; j <= moves.straightSteps; j++) {
+            if (i == 0 && j == 0) continue;
+            int x = fromX + i * ddx + j * sdx;
+            int y = fromY + i * ddy + j * sdy;
+            bool reached = false;
+            if (i > 0 && reach[(i - 1) * columns + j] && CanMove(map, x - ddx, y - ddy, moves.diagonalDir)) reached = true;
+            if (!reached && j > 0 && reach[i * columns + j - 1] && CanMove(map, x - sdx, y - sdy, moves.straightDir)) reached = true;
+            reach[i * columns + j] = reached ? 1 : 0;
+        }
+    }
+    return reach.back() != 0;
+}
+
+// չһhɴ·׷ӳĸ
+bool AppendMonotonePath(const GridMap& map, int from, int to, std::vector<unsigned char>& reach,
+    std::vector<int>& path) {
+    const int fromX = from % map.width, fromY = from / map.width;
+    const int toX = to % map.width, toY = to / map.width;
+    MonotoneMoves moves = GetMonotoneMoves(fromX, fromY, toX, toY);
+    if (!ComputeMonotoneReach(map, fromX, fromY, moves, reach)) return false;
+
+    const int columns = moves.straightSteps + 1;
+    const int ddx = moves.diagonalDir >= 0 ? SEARCH_DIRECTIONS[moves.diagonalDir][0] : 0;
+    const int ddy = moves.diagonalDir >= 0 ? SEARCH_DIRECTIONS[moves.diagonalDir][1] : 0;
+    const int sdx = moves.straightDir >= 0 ? SEARCH_DIRECTIONS[moves.straightDir][0] : 0;
+    const int sdy = moves.straightDir >= 0 ? SEARCH_DIRECTIONS[moves.straightDir][1] : 0;
+
+    // յ㵹ƣÿѡһɴƶϷǰ
+    const size_t first = path.size();
+    int i = moves.diagonalSteps, j = moves.straightSteps;
+    while (i > 0 || j > 0) {
+        int x = fromX + i * ddx + j * sdx;
+        int y = fromY + i * ddy + j * sdy;
+        path.push_back(map.Index(x, y));
+        if (i > 0 && reach[(i - 1) * columns + j] && CanMove(map, x - ddx, y - ddy, moves.diagonalDir)) {
+            i--;
+        }
+        else {
+            j--;
+        }
+    }
+    std::reverse(path.begin() + first, path.end());
+    return true;
+}
+
+} // namespace
+
+void SubgoalGraph::IndexSubgoals() {
+    subgoalOfCell.assign(static_cast<size_t>(width) * height, -1);
+    for (size_t i = 0; i < subgoalCells.size(); i++) {
+        subgoalOfCell[subgoalCells[i]] = static_cast<int>(i);
+    }
+}
+
+// 8һԽǷһֱ߷̬滮
+// ռ(x, y)ֱhɴĿ꣺Ŀ꼴¼ٴչ
+void SubgoalGraph::CollectDirectSubgoals(const GridMap& map, int x, int y, std::vector<int>& found) const {
+    found.clear();
+    const int origin = map.Index(x, y);
+    std::vector<unsigned char> previous, current;
+
+    for (int d = 4; d < 8; d++) {
+        const int ddx = SEARCH_DIRECTIONS[d][0];
+        const int ddy = SEARCH_DIRECTIONS[d][1];
+        const int straightDirs[2] = { DirectionIndex(ddx, 0), DirectionIndex(0, ddy) };
+
+        for (int straight : straightDirs) {
+            const int sdx = SEARCH_DIRECTIONS[straight][0];
+            const int sdy = SEARCH_DIRECTIONS[straight][1];
+
+            // ״̬0ɴ1ɴﲢչ2ɴĿ
+            previous.clear();
+            for (int i = 0; ; i++) {
+                int rowX = x + i * ddx, rowY = y + i * ddy;
+                if (!map.InBounds(rowX, rowY)) break;
+
+                current.clear();
+                bool expanding = false;
+                for (int j = 0; ; j++) {
+                    int cx = rowX + j * sdx, cy = rowY + j * sdy;
+                    if (!map.InBounds(cx, cy)) break;
+
+                    unsigned char state = 0;
+                    if (i == 0 && j == 0) {
+                        state = 1;
+                    }
+                    else if (!map.IsWall(cx, cy)) {
+                        bool reached = (j < static_cast<int>(previous.size()) && previous[j] == 1 &&
+                            CanMove(map, cx - ddx, cy - ddy, d)) ||
+                            (j > 0 && current[j - 1] == 1 && CanMove(map, cx - sdx, cy - sdy, straight));
+                        if (reached) {
+                            int id = subgoalOfCell[map.Index(cx, cy)];
+                            if (id >= 0) {
+                                state = 2;
+                                found.push_back(id);
+                            }
+                            else {
+                                state = 1;
+                            }
+                        }
+                    }
+                    if (state == 1) expanding = true;
+                    current.push_back(state);
+
+                    // кĸֻǰһеǰһԽʱǰ
+                    if (state != 1 && j + 1 >= static_cast<int>(previous.size())) break;
+                }
+                if (!expanding) break;
+                previous.swap(current);
+            }
+        }
+    }
+
+    // ֱԽϵĸȥ
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+    int self = subgoalOfCell[origin];
+    if (self >= 0) found.erase(std::remove(found.begin(), found.end(), self), found.end());
+}
+
+void SubgoalGraph::Build(const GridMap& map) {
+    width = map.width;
+    height = map.height;
+    wallHash = HashWalls(map);
+
+    subgoalCells.clear();
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (IsSubgoal(map, x, y)) subgoalCells.push_back(map.Index(x, y));
+        }
+    }
+    IndexSubgoals();
+
+    edgeOffsets.assign(1, 0);
+    edgeTargets.clear();
+    std::vector<int> found;
+    for (size_t i = 0; i < subgoalCells.size(); i++) {
+        CollectDirectSubgoals(map, subgoalCells[i] % width, subgoalCells[i] / width, found);
+        edgeTargets.insert(edgeTargets.end(), found.begin(), found.end());
+        edgeOffsets.push_back(static_cast<int>(edgeTargets.size()));
+    }
+}
+
+bool SubgoalGraph::IsBuiltFor(const GridMap& map) const {
+    return !edgeOffsets.empty() && width == map.width && height == map.height && wallHash == HashWalls(map);
+}
+
+bool SubgoalGraph::FindPath(const GridMap& map, int startX, int startY, int goalX, int goalY,
+    SubgoalQueryWorkspace& workspace, SearchResult& result) const {
+    result.found = false;
+    result.cost = 0;
+    result.path.clear();
+    result.expanded = 0;
+
+    if (map.IsWall(startX, startY) || map.IsWall(goalX, goalY)) return false;
+
+    const int start = map.Index(startX, startY);
+    const int goal = map.Index(goalX, goalY);
+    result.path.push_back(start);
+
+    // յhɴʱֱչĿͼ
+    if (start == goal || AppendMonotonePath(map, start, goal, workspace.refineReach, result.path)) {
+        result.found = true;
+        result.cost = OctileDistance(startX, startY, goalX, goalY);
+        return true;
+    }
+    result.path.clear();
+
+    // ͼڵ㣺0..N-1ΪĿ꣬յ㱾ĿʱֱNN + 1ʾ
+    const int subgoalCount = static_cast<int>(subgoalCells.size());
+    const int startNode = subgoalOfCell[start] >= 0 ? subgoalOfCell[start] : subgoalCount;
+    const int goalNode = subgoalOfCell[goal] >= 0 ? subgoalOfCell[goal] : subgoalCount + 1;
+    auto nodeCell = [&](int node) {
+        return node < subgoalCount ? subgoalCells[node] : (node == subgoalCount ? start : goal);
+    };
+
+    workspace.startEdges.clear();
+    if (startNode == subgoalCount) CollectDirectSubgoals(map, startX, startY, workspace.startEdges);
+
+    workspace.goalEdges.clear();
+    if (goalNode == subgoalCount + 1) CollectDirectSubgoals(map, goalX, goalY, workspace.goalEdges);
+    if (static_cast<int>(workspace.goalEdgeMark.size()) < subgoalCount) {
+        workspace.goalEdgeMark.resize(subgoalCount, 0);
+    }
+    for (int id : workspace.goalEdges) workspace.goalEdgeMark[id] = 1;
+
+    struct OpenEntry {
+        int f;
+        int g;
+        int node;
+        bool operator<(const OpenEntry& other) const {
+            return f > other.f || (f == other.f && g < other.g);
+        }
+    };
+
+    SearchWorkspace& ws = workspace.search;
+    ws.Begin(subgoalCount + 2);
+    std::priority_queue<OpenEntry> openSet;
+    ws.Open(startNode, 0, -1);
+    openSet.push({ OctileDistance(startX, startY, goalX, goalY), 0, startNode });
+    SEARCH_PROFILE_PUSH(ws, startX, startY);
+
+    auto relax = [&](int node, int next) {
+        if (ws.IsClosed(next)) return;
+        int from = nodeCell(node), to = nodeCell(next);
+        int newG = ws.g[node] + OctileDistance(from % width, from / width, to % width, to / width);
+        if (newG >= ws.G(next)) return;
+        ws.Open(next, newG, node);
+        openSet.push({ newG + OctileDistance(to % width, to / width, goalX, goalY), newG, next });
+        SEARCH_PROFILE_PUSH(ws, to % width, to / width);
+    };
+
+    bool found = false;
+    while (!openSet.empty()) {
+        OpenEntry top = openSet.top();
+        openSet.pop();
+        if (ws.IsClosed(top.node)) continue;
+        ws.Close(top.node);
+        result.expanded++;
+        SEARCH_PROFILE_EXPAND(ws, nodeCell(top.node) % width, nodeCell(top.node) / width);
+
+        if (top.node == goalNode) {
+            found = true;
+            break;
+        }
+
+        if (top.node == subgoalCount) {
+            for (int next : workspace.startEdges) relax(top.node, next);
+            continue;
+        }
+        if (top.node < subgoalCount) {
+            for (int e = edgeOffsets[top.node]; e < edgeOffsets[top.node + 1]; e++) relax(top.node, edgeTargets[e]);
+            if (workspace.goalEdgeMark[top.node]) relax(top.node, subgoalCount + 1);
+        }
+    }
+
+    for (int id : workspace.goalEdges) workspace.goalEdgeMark[id] = 0;
+    if (!found) return false;
+
+    // ĿУٰÿչΪ·
+    std::vector<int> nodes;
+    for (int node = goalNode; node != -1; node = ws.Parent(node)) {
+        nodes.push_back(nodeCell(node));
+        if (node == startNode) break;
+    }
+    std::reverse(nodes.begin(), nodes.end());
+
+    result.path.push_back(start);
+    for (size_t i = 1; i < nodes.size(); i++) {
+        if (!AppendMonotonePath(map, nodes[i - 1], nodes[i], workspace.refineReach, result.path)) {
+            result.path.clear();
+            return false;
+        }
+    }
+    result.found = true;
+    result.cost = ws.G(goalNode);
+    return true;
+}
+
+std::string SubgoalGraph::Serialize() const {
+    ChunkWriter writer;
+    writer.WriteInt(width);
+    writer.WriteInt(height);
+    writer.WriteUInt(wallHash);
+    writer.WriteInts(subgoalCells);
+    writer.WriteInts(edgeOffsets);
+    writer.WriteInts(edgeTargets);
+    return writer.Sealed();
+}
+
+bool SubgoalGraph::Deserialize(const std::string& payload, const GridMap& map) {
+    ChunkReader reader(payload);
+    reader.Unseal();
+    int readWidth = reader.ReadInt();
+    int readHeight = reader.ReadInt();
+    uint32_t readHash = reader.ReadUInt();
+    std::vector<int> cells, offsets, targets;
+    reader.ReadInts(cells);
+    reader.ReadInts(offsets);
+    reader.ReadInts(targets);
+
+    if (!reader.AtEnd() || readWidth != map.width || readHeight != map.height || readHash != HashWalls(map)) {
+        return false;
+    }
+
+    // Χ𻵵ļԽ
+    const int cellCount = map.CellCount();
+    const int count = static_cast<int>(cells.size());
+    if (offsets.size() != cells.size() + 1 || offsets.front() != 0 || offsets.back() != static_cast<int>(targets.size())) {
+        return false;
+    }
+    for (int cell : cells) {
+        if (cell < 0 || cell >= cellCount || map.walls[cell]) return false;
+    }
+    for (size_t i = 1; i < offsets.size(); i++) {
+        if (offsets[i] < offsets[i - 1]) return false;
+    }
+    for (int target : targets) {
+        if (target < 0 || target >= count) return false;
+    }
+
+    width = readWidth;
+    height = readHeight;
+    wallHash = readHash;
+    subgoalCells.swap(cells);
+    edgeOffsets.swap(offsets);
+    edgeTargets.swap(targets);
+    IndexSubgoals();
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "grid_map.h"
+#include "search_kernel.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// ĿͼSimple Subgoal Graph
+// ǽǴĿ꣬ӱ˴ˡֱhɴڴ۵ڰ˷·;Ŀ꣩Ŀԡ
+// ѯʱյͼУСͼA*ٰÿչΪƶ
+// ֻ֧8CORNER_BLOCK_BOTH򣨿ӻߵƶ
+
+// ѯõĿɸʱ
+struct SubgoalQueryWorkspace {
+    SearchWorkspace search;
+    std::vector<int> startEdges;      // ֱhɴĿ
+    std::vector<int> goalEdges;       // ֱhɴյĿ
+    std::vector<int> goalEdgeMark;    // ĿűǷյ
+    std::vector<unsigned char> refineReach;
+};
+
+class SubgoalGraph {
+public:
+    SubgoalGraph() : width(0), height(0), wallHash(0) {}
+
+    // ԵͼԤ
+    void Build(const GridMap& map);
+
+    // ԤǷõͼһ
+    bool IsBuiltFor(const GridMap& map) const;
+
+    // ѯ·result.pathΪԭʼͼ
+    bool FindPath(const GridMap& map, int startX, int startY, int goalX, int goalY,
+        SubgoalQueryWorkspace& workspace, SearchResult& result) const;
+
+    // лΪͼļչݣʱͼԤһ»򷵻false
+    std::string Serialize() const;
+    bool Deserialize(const std::string& payload, const GridMap& map);
+
+    size_t SubgoalCount() const { return subgoalCells.size(); }
+    size_t EdgeCount() const { return edgeTargets.size(); }
+
+private:
+    void IndexSubgoals();
+    void CollectDirectSubgoals(const GridMap& map, int x, int y, std::vector<int>& found) const;
+
+    int width;
+    int height;
+    uint32_t wallHash;
+    std::vector<int> subgoalCells;      // Ŀ
+    std::vector<int> subgoalOfCell;     // ÿӦĿţ-1ʾĿ
+    std::vector<int> edgeOffsets;       // ڽӱƫƣĿţ
+    std::vector<int> edgeTargets;       // ĿţߵĴΪİ˷
+};
@@ -0,0 +1,1431 @@
+#include "verify_harness.h"
+#include "reference_search.h"
+#include "search_kernel.h"
+#include "search_stepper.h"
+#include "ara_star.h"
+#include "subgoal_graph.h"
+#include "path_database.h"
+#include "jps_plus.h"
+#include "rectangle_graph.h"
+#include "parallel_search.h"
+#include "distance_field.h"
+#include "multi_goal.h"
+#include "multi_agent.h"
+#include "path_encoding.h"
+#include "map_edit.h"
+#include "map_file.h"
+#include "search_profiler.h"
+
+#include <ostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <queue>
+#include <functional>
+#include <iterator>
+#include <cstdio>
+#include <thread>
+#include <iomanip>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// 棺PrepareÿŵͼԤ£Queryִеβѯ
+// Ԥ۹ߵͨSupportsͼOptionsѯʹõƶ򣬻׼ͬĹ
+class VerifyEngine {
+public:
+    virtual ~VerifyEngine() {}
+    virtual const char* Name() const = 0;
+    virtual bool Supports(const GridMap&) const { return true; }
+    virtual SearchOptions Options() const { return SearchOptions(); }
+    virtual void Prepare(const GridMap& map) = 0;
+    virtual bool Query(int startX, int startY, int goalX, int goalY, SearchResult& result) = 0;
+    // һβѯĴޣŴ۵ıԼǷûҵ·ֹʱжϵſ
+    virtual double CostBound() const { return 1.0; }
+    virtual bool MayGiveUp() const { return false; }
+};
+
+SearchOptions MakeSearchOptions(int connectivity, CornerRule cornerRule) {
+    SearchOptions options;
+    options.connectivity = connectivity;
+    options.cornerRule = cornerRule;
+    return options;
+}
+
+class KernelEngine : public VerifyEngine {
+public:
+    KernelEngine(const char* name, const SearchOptions& options) : name(name), options(options) {}
+    const char* Name() const override { return name; }
+    SearchOptions Options() const override { return options; }
+    void Prepare(const GridMap& map) override { grid.Build(map); }
+    bool Query(int startX, int startY, int goalX, int goalY, SearchResult& result) override {
+        return RunGridSearch(grid, startX, startY, goalX, goalY, options, workspace, result);
+    }
+
+private:
+    const char* name;
+    SearchOptions options;
+    PaddedGrid grid;
+    SearchWorkspace workspace;
+};
+
+class StepperEngine : public VerifyEngine {
+public:
+    const char* Name() const override { return "stepper"; }
+    void Prepare(const GridMap& map) override { grid.Build(map); }
+    bool Query(int startX, int startY, int goalX, int goalY, SearchResult& result) override {
+        result = SearchResult();
+        stepper.Start(grid, startX, startY, goalX, goalY);
+        stepper.Step(std::numeric_limits<size_t>::max());
+        result.expanded = stepper.Expanded();
+        result.found = stepper.GetPath(result.path);
+        result.cost = result.found ? stepper.Cost() : 0;
+        return result.found;
+    }
+
+private:
+    PaddedGrid grid;
+    SearchStepper stepper;
+};
+
+// ֹʱARA*Ӧ·˽ֹʱʱ۲ĴŽŴۣ
+// ڵõһ·֮ǰжûн
+class AnytimeEngine : public VerifyEngine {
+public:
+    AnytimeEngine(const char* name, long long deadlineMicros) : name(name), deadlineMicros(deadlineMicros) {}
+    const char* Name() const override { return name; }
+    void Prepare(const GridMap& map) override { grid.Build(map); }
+    bool Query(int startX, int startY, int goalX, int goalY, SearchResult& result) override {
+        AnytimeOptions options;
+        options.initialWeight = 2.0;
+        options.deadlineMicros = deadlineMicros;
+        RunAnytimeSearch(grid, startX, startY, goalX, goalY, options, workspace, last);
+        result = last;
+        return result.found;
+    }
+    double CostBound() const override { return last.optimal ? 1.0 : last.bound; }
+    bool MayGiveUp() const override { return last.interrupted; }
+
+private:
+    const char* name;
+    long long deadlineMicros;
+    PaddedGrid grid;
+    AnytimeWorkspace workspace;
+    AnytimeResult last;
+};
+
+// ĿͼĹԤ
+class SubgoalEngine : public VerifyEngine {
+public:
+    const char* Name() const override { return "subgoal"; }
+    void Prepare(const GridMap& map) override {
+        current = map;
+        graph.Build(map);
+    }
+    bool Query(int startX, int startY, int goalX, int goalY, SearchResult& result) override {
+        return graph.FindPath(current, startX, startY, goalX, goalY, workspace, result);
+    }
+
+private:
+    GridMap current;
+    SubgoalGraph graph;
+    SubgoalQueryWorkspace workspace;
+};
+
+// JPS+ӿյͼʼǽͬʱµĽ
+class JumpPointEngine : public VerifyEngine {
+public:
+    const char* Name() const override { return "jps_plus"; }
+    bool Supports(const GridMap& map) const override { return JumpTable::Supports(map); }
+    void Prepare(const GridMap& map) override {
+        current = GridMap(map.width, map.height);
+        table.Build(current);
+        for (int i = 0; i < map.CellCount(); i++) {
+            if (!map.walls[i]) continue;
+            current.walls[i] = 1;
+            table.SetWall(current, i % map.width, i / map.width);
+        }
+    }
+    bool Query(int startX, int startY, int goalX, int goalY, SearchResult& result) override {
+        return table.FindPath(current, startX, startY, goalX, goalY, workspace, result);
+    }
+
+private:
+    GridMap current;
+    JumpTable table;
+    SearchWorkspace workspace;
+};
+
+// ηֽͬԤ
+class RectangleEngine : public VerifyEngine {
+public:
+    const char* Name() const override { return "rsr"; }
+    void Prepare(const GridMap& map) override {
+        current = map;
+        graph.Build(map);
+    }
+    bool Query(int startX, int startY, int goalX, int goalY, SearchResult& result) override {
+        return graph.FindPath(current, startX, startY, goalX, goalY, workspace, result);
+    }
+
+private:
+    GridMap current;
+    RectangleGraph graph;
+    SearchWorkspace workspace;
+};
+
+// ѹ·ݿԤȫ·ֻСͼϼ
+const int PATH_DB_MAX_CELLS = 2048;
+
+class PathDatabaseEngine : public VerifyEngine {
+public:
+    const char* Name() const override { return "path_db"; }
+    bool Supports(const GridMap& map) const override { return map.CellCount() <= PATH_DB_MAX_CELLS; }
+    void Prepare(const GridMap& map) override { database.Build(map); }
+    bool Query(int startX, int startY, int goalX, int goalY, SearchResult& result) override {
+        return database.FindPath(startX, startY, goalX, goalY, result);
+    }
+
+private:
+    PathDatabase database;
+};
+
+// A*̶4̣߳ʹ˻ҲύִвϢ
+class ParallelEngine : public VerifyEngine {
+public:
+    const char* Name() const override { return "parallel"; }
+    void Prepare(const GridMap& map) override { grid.Build(map); }
+    bool Query(int startX, int startY, int goalX, int goalY, SearchResult& result) override {
+        ParallelSearchOptions options;
+        options.threadCount = 4;
+        return RunParallelSearch(grid, startX, startY, goalX, goalY, options, workspace, result);
+    }
+
+private:
+    PaddedGrid grid;
+    SearchWorkspace workspace;
+};
+
+// յյ㼯ΪյǽǽԶˣֵֻ
+// ǽGOAL_INDEX_THRESHOLDʱ߿ռӦ뵥յͬ
+class MultiGoalEngine : public VerifyEngine {
+public:
+    const char* Name() const override { return "multi_goal"; }
+    void Prepare(const GridMap& map) override {
+        grid.Build(map);
+        walls.Reset(map.width, map.height);
+        for (int y = 0; y < map.height; y++) {
+            for (int x = 0; x < map.width; x++) {
+                if (map.walls[map.Index(x, y)]) walls.Add(x, y);
+            }
+        }
+    }
+    bool Query(int startX, int startY, int goalX, int goalY, SearchResult& result) override {
+        goals = walls;
+        goals.Add(goalX, goalY);
+        int reached;
+        return RunMultiGoalSearch(grid, startX, startY, goals, SearchOptions(), workspace, result, reached);
+    }
+
+private:
+    PaddedGrid grid;
+    GoalSet walls;
+    GoalSet goals;
+    SearchWorkspace workspace;
+};
+
+// 볡ŵͼյĴۣٴش½ķߵյ㣨ƶԳƣ
+// expandedΪ볡ǵĸ
+class DistanceFieldEngine : public VerifyEngine {
+public:
+    DistanceFieldEngine(const char* name, const SearchOptions& options) : name(name), options(options) {}
+    const char* Name() const override { return name; }
+    SearchOptions Options() const override { return options; }
+    void Prepare(const GridMap& map) override { current = map; }
+    bool Query(int startX, int startY, int goalX, int goalY, SearchResult& result) override {
+        result = SearchResult();
+        ComputeCostField(current, std::vector<int>(1, current.Index(goalX, goalY)), options, field);
+        for (size_t i = 0; i < field.size(); i++) {
+            if (field[i] != DISTANCE_UNREACHABLE) result.expanded++;
+        }
+
+        int cell = current.Index(startX, startY);
+        if (field[cell] == DISTANCE_UNREACHABLE) return false;
+        result.path.push_back(cell);
+        while (field[cell] > 0) {
+            const int x = cell % current.width, y = cell / current.width;
+            int next = -1;
+            for (int d = 0; d < options.connectivity && next < 0; d++) {
+                if (!CanMove(current, x, y, d, options.cornerRule)) continue;
+                const int neighbor = current.Index(x + SEARCH_DIRECTIONS[d][0], y + SEARCH_DIRECTIONS[d][1]);
+                if (field[neighbor] != DISTANCE_UNREACHABLE && field[neighbor] + MoveCost(d) == field[cell]) next = neighbor;
+            }
+            if (next < 0) return false;
+            result.path.push_back(next);
+            cell = next;
+        }
+        result.found = true;
+        result.cost = field[current.Index(startX, startY)];
+        return true;
+    }
+
+private:
+    const char* name;
+    SearchOptions options;
+    GridMap current;
+    std::vector<int> field;
+};
+
+std::vector<std::unique_ptr<VerifyEngine> > CreateEngines() {
+    std::vector<std::unique_ptr<VerifyEngine> > engines;
+    engines.emplace_back(new KernelEngine("kernel", SearchOptions()));
+    engines.emplace_back(new KernelEngine("kernel_4", MakeSearchOptions(4, CORNER_BLOCK_BOTH)));
+    engines.emplace_back(new KernelEngine("kernel_corner_any", MakeSearchOptions(8, CORNER_BLOCK_ANY)));
+    engines.emplace_back(new StepperEngine());
+    engines.emplace_back(new AnytimeEngine("anytime", 0));
+    // ֹʱ㹻̣ϴĵͼϻǰж
+    engines.emplace_back(new AnytimeEngine("anytime_deadline", 50));
+    engines.emplace_back(new SubgoalEngine());
+    engines.emplace_back(new JumpPointEngine());
+    engines.emplace_back(new RectangleEngine());
+    engines.emplace_back(new PathDatabaseEngine());
+    engines.emplace_back(new ParallelEngine());
+    engines.emplace_back(new DistanceFieldEngine("distance_field", SearchOptions()));
+    engines.emplace_back(new DistanceFieldEngine("distance_field_4", MakeSearchOptions(4, CORNER_BLOCK_BOTH)));
+    engines.emplace_back(new DistanceFieldEngine("distance_field_corner_any", MakeSearchOptions(8, CORNER_BLOCK_ANY)));
+    engines.emplace_back(new MultiGoalEngine());
+    return engines;
+}
+
+// ·ϷԲۣǷʱ-1
+int CheckPath(const GridMap& map, const std::vector<int>& path, int start, int goal, const SearchOptions& options) {
+    if (path.empty() || path.front() != start || path.back() != goal) return -1;
+
+    int cost = 0;
+    for (size_t i = 1; i < path.size(); i++) {
+        int x = path[i - 1] % map.width;
+        int y = path[i - 1] / map.width;
+        int dx = path[i] % map.width - x;
+        int dy = path[i] / map.width - y;
+
+        int dir = -1;
+        for (int d = 0; d < options.connectivity; d++) {
+            if (SEARCH_DIRECTIONS[d][0] == dx && SEARCH_DIRECTIONS[d][1] == dy) dir = d;
+        }
+        if (dir < 0 || !CanMove(map, x, y, dir, options.cornerRule)) return -1;
+        cost += MoveCost(dir);
+    }
+    return cost;
+}
+
+// Ľոʽγ̱Ӧõԭ·ʱ賤ȣ
+// ͬγֻǰһPATH_RUN_MAXʱ֣յ㱣յ㣬
+// ڹյ֮䰴ֱ߻45бչӦõԭ·Ȼ䣩ûʱΪ
+std::string CheckPathEncoding(const GridMap& map, const std::vector<int>& path) {
+    const size_t required = EncodeDirectionRuns(path.data(), path.size(), map.width, nullptr, 0);
+    if (required == PATH_RUNS_INVALID) return "runs: encoder rejected a valid path";
+    std::vector<unsigned char> runs(required + 1, 0xFF);
+    if (required > 0 && EncodeDirectionRuns(path.data(), path.size(), map.width, runs.data(), required - 1) != required) {
+        return "runs: undersized buffer does not report the required size";
+    }
+    if (required > 0 && runs[required - 1] != 0xFF) return "runs: undersized buffer was overrun";
+    if (EncodeDirectionRuns(path.data(), path.size(), map.width, runs.data(), required) != required) {
+        return "runs: encoded length differs between calls";
+    }
+    for (size_t i = 1; i < required; i++) {
+        if ((runs[i] >> 5) == (runs[i - 1] >> 5) && (runs[i - 1] & 31) + 1 != PATH_RUN_MAX) {
+            return "runs: a run shorter than PATH_RUN_MAX is followed by the same direction";
+        }
+    }
+    if (DecodeDirectionRuns(runs.data(), required, path.front(), map.width, nullptr, 0) != path.size()) {
+        return "runs: undersized decode buffer does not report the required size";
+    }
+    std::vector<int> decoded(path.size());
+    DecodeDirectionRuns(runs.data(), required, path.front(), map.width, decoded.data(), decoded.size());
+    if (decoded != path) return "runs: decoded path differs";
+
+    std::vector<int> waypoints(path);
+    const size_t count = CollapseWaypoints(path.data(), path.size(), map.width, nullptr, 0);
+    int first = -1;
+    if (CollapseWaypoints(path.data(), path.size(), map.width, &first, 1) != count || first != path.front()) {
+        return "waypoints: undersized buffer does not report the required size";
+    }
+    if (CollapseWaypoints(waypoints.data(), waypoints.size(), map.width, waypoints.data(), waypoints.size()) != count) {
+        return "waypoints: in-place collapse differs";
+    }
+    waypoints.resize(count);
+    if (waypoints.empty() || waypoints.front() != path.front() || waypoints.back() != path.back()) {
+        return "waypoints: endpoints not kept";
+    }
+    std::vector<int> expanded(1, waypoints[0]);
+    for (size_t i = 1; i < waypoints.size(); i++) {
+        int x = waypoints[i - 1] % map.width, y = waypoints[i - 1] / map.width;
+        const int toX = waypoints[i] % map.width, toY = waypoints[i] / map.width;
+        if (toX - x != 0 && toY - y != 0 && abs(toX - x) != abs(toY - y)) return "waypoints: segment is not straight or 45 degrees";
+        while (x != toX || y != toY) {
+            x += toX > x ? 1 : (toX < x ? -1 : 0);
+            y += toY > y ? 1 : (toY < y ? -1 : 0);
+            expanded.push_back(map.Index(x, y));
+        }
+    }
+    if (expanded != path) return "waypoints: expanding the waypoints does not give the path";
+    return std::string();
+}
+
+// ı߽ڵлƱֱܾ߰PATH_RUN_MAX֣·ûγ
+int CheckEncodingEdgeCases(std::ostream& log) {
+    const int width = 128;
+    std::vector<std::string> problems;
+    const int jump[] = { 0, 2 };
+    const int wrap[] = { width - 1, width };
+    if (EncodeDirectionRuns(jump, 2, width, nullptr, 0) != PATH_RUNS_INVALID) problems.push_back("non-adjacent step accepted");
+    if (EncodeDirectionRuns(wrap, 2, width, nullptr, 0) != PATH_RUNS_INVALID) problems.push_back("row wrap-around accepted");
+
+    std::vector<int> line;
+    for (int x = 0; x <= 3 * PATH_RUN_MAX + 4; x++) line.push_back(x);
+    unsigned char runs[8];
+    const size_t count = EncodeDirectionRuns(line.data(), line.size(), width, runs, 8);
+    if (count != 4 || (runs[0] & 31) + 1 != PATH_RUN_MAX || (runs[3] & 31) + 1 != 4) problems.push_back("long run not split");
+
+    const int single = 5;
+    if (EncodeDirectionRuns(&single, 1, width, runs, 8) != 0) problems.push_back("single-cell path has runs");
+    int cells[2];
+    if (DecodeDirectionRuns(runs, 0, single, width, cells, 2) != 1 || cells[0] != single) problems.push_back("single-cell decode");
+    if (CollapseWaypoints(&single, 1, width, cells, 2) != 1 || cells[0] != single) problems.push_back("single-cell waypoints");
+
+    for (size_t i = 0; i < problems.size(); i++) log << "FAIL path_encoding: " << problems[i] << "\n";
+    return static_cast<int>(problems.size());
+}
+
+GridMap GenerateMap(std::mt19937& random, int width, int height, int wallPercent) {
+    GridMap map(width, height);
+    for (size_t i = 0; i < map.walls.size(); i++) {
+        map.walls[i] = static_cast<int>(random() % 100) < wallPercent ? 1 : 0;
+    }
+    return map;
+}
+
+struct EngineStats {
+    size_t queries = 0;
+    size_t expanded = 0;
+    double seconds = 0.0;
+    int failures = 0;
+};
+
+// ͼ볡滮ֻڲôӵĵͼϼ飺׼DijkstraǽȽϺʱ䲽չ
+const int ORACLE_MAX_CELLS = 4096;
+// ʱÿŵͼĲѯ
+const unsigned int TIMING_SEED = 12345;
+const int TIMING_QUERIES_PER_MAP = 8;
+// A*򵥸ѯһŴͼ뵥߳ں˱ȽͬһԽǳѯĺʱ
+const int LARGE_MAP_SIDE = 1024;
+const int LARGE_MAP_WALL_PERCENT = 20;
+const int LARGE_MAP_QUERIES = 2;
+const int AGENT_CHECK_MAX_AGENTS = 16;
+
+// ׼볡ԴDijkstraunitCostΪtrueʱÿ110/14ۣǽͲɴĸΪDISTANCE_UNREACHABLE
+void OracleField(const GridMap& map, const std::vector<int>& sources, const SearchOptions& options, bool unitCost,
+    std::vector<int>& distances) {
+    distances.assign(map.CellCount(), DISTANCE_UNREACHABLE);
+    typedef std::pair<int, int> Entry;   // (, )
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+    for (int source : sources) {
+        if (map.walls[source]) continue;
+        distances[source] = 0;
+        open.push(Entry(0, source));
+    }
+    while (!open.empty()) {
+        const Entry top = open.top();
+        open.pop();
+        if (top.first != distances[top.second]) continue;
+        const int x = top.second % map.width, y = top.second / map.width;
+        for (int d = 0; d < options.connectivity; d++) {
+            if (!CanMove(map, x, y, d, options.cornerRule)) continue;
+            const int next = map.Index(x + SEARCH_DIRECTIONS[d][0], y + SEARCH_DIRECTIONS[d][1]);
+            const int distance = top.first + (unitCost ? 1 : MoveCost(d));
+            if (distances[next] == DISTANCE_UNREACHABLE || distance < distances[next]) {
+                distances[next] = distance;
+                open.push(Entry(distance, next));
+            }
+        }
+    }
+}
+
+const SearchOptions MOVEMENT_RULES[] = { SearchOptions(), MakeSearchOptions(4, CORNER_BLOCK_BOTH),
+    MakeSearchOptions(8, CORNER_BLOCK_ANY), MakeSearchOptions(4, CORNER_BLOCK_ANY) };
+
+// 13Դ
+std::vector<int> PickSources(const std::vector<int>& freeCells, std::mt19937& random) {
+    std::vector<int> sources(1 + random() % 3);
+    for (size_t i = 0; i < sources.size(); i++) sources[i] = freeCells[random() % freeCells.size()];
+    return sources;
+}
+
+// ͼ볡ÿƶµĲʹ۳Dijkstraͬ
+// ǽľǽԼͼ⣩Ƚϰ˷Ľͬ
+void CheckDistanceFields(std::ostream& log, const GridMap& map, const std::vector<int>& sources,
+    EngineStats& stats, int& reported, int maxReportedFailures) {
+
+    std::vector<int> actual, expected;
+    auto compare = [&](const char* kind, const SearchOptions& options) {
+        stats.queries++;
+        size_t cell = 0;
+        while (cell < expected.size() && actual.size() == expected.size() && actual[cell] == expected[cell]) cell++;
+        if (cell == expected.size() && actual.size() == expected.size()) return;
+
+        stats.failures++;
+        if (reported++ < maxReportedFailures) {
+            log << "FAIL distance_fields: " << map.width << "x" << map.height << " " << kind << " field, connectivity "
+                << options.connectivity << (options.cornerRule == CORNER_BLOCK_ANY ? " corner any" : " corner both");
+            if (actual.size() != expected.size()) {
+                log << ": " << actual.size() << " cells != " << expected.size() << "\n";
+            }
+            else {
+                log << ": (" << cell % map.width << "," << cell / map.width << ") " << actual[cell] << " != reference "
+                    << expected[cell] << "\n";
+            }
+        }
+    };
+
+    for (const SearchOptions& options : MOVEMENT_RULES) {
+        ComputeStepField(map, sources, options, actual);
+        OracleField(map, sources, options, true, expected);
+        compare("step", options);
+
+        ComputeCostField(map, sources, options, actual);
+        OracleField(map, sources, options, false, expected);
+        compare("cost", options);
+    }
+
+    ComputeWallDistance(map, actual);
+    expected.assign(map.CellCount(), 0);
+    for (int cell = 0; cell < map.CellCount(); cell++) {
+        if (map.walls[cell]) continue;
+        const int x = cell % map.width, y = cell / map.width;
+        // ͼĸҡϻ
+        int nearest = COST_STRAIGHT * std::min(std::min(x + 1, map.width - x), std::min(y + 1, map.height - y));
+        for (int wall = 0; wall < map.CellCount(); wall++) {
+            if (map.walls[wall]) nearest = std::min(nearest, OctileDistance(x, y, wall % map.width, wall / map.width));
+        }
+        expected[cell] = nearest;
+    }
+    compare("wall", SearchOptions());
+}
+
+// ͬһݹظroundsΣȡһμͳƣٵ뻺ɵĶworkչ
+template <typename Work>
+void TimeBestOf(int rounds, EngineStats& stats, Work work) {
+    double best = std::numeric_limits<double>::max();
+    size_t expanded = 0;
+    for (int r = 0; r < std::max(rounds, 1); r++) {
+        Clock::time_point begin = Clock::now();
+        expanded = work();
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - begin).count());
+    }
+    stats.seconds += best;
+    stats.expanded += expanded;
+}
+
+// ʱƶµĲ۳Լǽ룬expandedΪ볡ǵĸ
+size_t RunDistanceFields(const GridMap& map, const std::vector<int>& sources, std::vector<int>& distances) {
+    size_t covered = 0;
+    auto count = [&]() {
+        for (size_t i = 0; i < distances.size(); i++) {
+            if (distances[i] != DISTANCE_UNREACHABLE) covered++;
+        }
+    };
+    for (const SearchOptions& options : MOVEMENT_RULES) {
+        ComputeStepField(map, sources, options, distances);
+        count();
+        ComputeCostField(map, sources, options, distances);
+        count();
+    }
+    ComputeWallDistance(map, distances);
+    count();
+    return covered;
+}
+
+// tʱڸӣյͣյ
+int AgentCell(const std::vector<int>& path, int time) {
+    return path[std::min(time, static_cast<int>(path.size()) - 1)];
+}
+
+// ·timetime + 1֮Ƿͻ㡢򽻻бͬһ2x2
+bool AgentsCollide(const GridMap& map, const std::vector<int>& a, const std::vector<int>& b, int time) {
+    const int a0 = AgentCell(a, time), a1 = AgentCell(a, time + 1);
+    const int b0 = AgentCell(b, time), b1 = AgentCell(b, time + 1);
+    if (a0 == b0 || a1 == b1) return true;
+    if (a0 != a1 && a0 == b1 && a1 == b0) return true;
+    const int dx = a1 % map.width - a0 % map.width, dy = a1 / map.width - a0 / map.width;
+    if (dx == 0 || dy == 0) return false;
+    const int sideA = a0 + dx, sideB = a0 + dy * map.width;
+    return (b0 == sideA && b1 == sideB) || (b0 == sideB && b1 == sideA);
+}
+
+// һ·ÿƶԭصȴشۣǷʱ-1
+int CheckAgentPath(const GridMap& map, const std::vector<int>& path, int start, int goal, const SearchOptions& options) {
+    if (path.empty() || path.front() != start || path.back() != goal) return -1;
+    int cost = 0;
+    for (size_t i = 1; i < path.size(); i++) {
+        if (path[i] == path[i - 1]) {
+            cost += COST_WAIT;
+            continue;
+        }
+        const int x = path[i - 1] % map.width, y = path[i - 1] / map.width;
+        int dir = -1;
+        for (int d = 0; d < options.connectivity; d++) {
+            if (map.InBounds(x + SEARCH_DIRECTIONS[d][0], y + SEARCH_DIRECTIONS[d][1]) &&
+                map.Index(x + SEARCH_DIRECTIONS[d][0], y + SEARCH_DIRECTIONS[d][1]) == path[i]) dir = d;
+        }
+        if (dir < 0 || !CanMove(map, x, y, dir, options.cornerRule)) return -1;
+        cost += MoveCost(dir);
+    }
+    return cost;
+}
+
+// ׼(, ʱ)չDijkstraܿȹ滮·ԤԼʱ䲻horizon
+// յҴ˺˾ʱشۣɴﷵ-1
+int TimeExpandedCost(const GridMap& map, const std::vector<std::vector<int> >& earlier, int start, int goal,
+    const SearchOptions& options, int horizon) {
+    const int cells = map.CellCount();
+    std::vector<int> occupant(static_cast<size_t>(horizon + 2) * cells, -1);
+    std::vector<int> lastVisit(cells, -1);
+    for (size_t i = 0; i < earlier.size(); i++) {
+        for (int t = 0; t <= horizon + 1; t++) occupant[static_cast<size_t>(t) * cells + AgentCell(earlier[i], t)] = static_cast<int>(i);
+        const std::vector<int>& path = earlier[i];
+        for (size_t t = 0; t + 1 < path.size(); t++) lastVisit[path[t]] = std::max(lastVisit[path[t]], static_cast<int>(t));
+        lastVisit[path.back()] = std::numeric_limits<int>::max();
+    }
+    auto occupiedBy = [&](int cell, int time) { return occupant[static_cast<size_t>(time) * cells + cell]; };
+    auto moves = [&](int from, int to, int time) {
+        const int who = occupiedBy(from, time);
+        return who >= 0 && AgentCell(earlier[who], time + 1) == to;
+    };
+    if (occupiedBy(start, 0) >= 0) return -1;
+
+    typedef std::pair<int, int> Entry;   // (, ʱ * cells + )
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+    std::vector<int> best(static_cast<size_t>(horizon + 1) * cells, std::numeric_limits<int>::max());
+    best[start] = 0;
+    open.push(Entry(0, start));
+    while (!open.empty()) {
+        const Entry top = open.top();
+        open.pop();
+        if (top.first != best[top.second]) continue;
+        const int cell = top.second % cells, time = top.second / cells;
+        if (cell == goal && lastVisit[goal] < time) return top.first;
+        if (time == horizon) continue;
+
+        auto relax = [&](int next, int cost) {
+            const int state = (time + 1) * cells + next;
+            if (top.first + cost < best[state]) {
+                best[state] = top.first + cost;
+                open.push(Entry(best[state], state));
+            }
+        };
+        if (occupiedBy(cell, time + 1) < 0) relax(cell, COST_WAIT);
+        const int x = cell % map.width, y = cell / map.width;
+        for (int d = 0; d < options.connectivity; d++) {
+            if (!CanMove(map, x, y, d, options.cornerRule)) continue;
+            const int dx = SEARCH_DIRECTIONS[d][0], dy = SEARCH_DIRECTIONS[d][1];
+            const int next = map.Index(x + dx, y + dy);
+            if (occupiedBy(next, time + 1) >= 0 || moves(next, cell, time)) continue;
+            if (dx != 0 && dy != 0) {
+                const int sideA = map.Index(x + dx, y), sideB = map.Index(x, y + dy);
+                if (moves(sideA, sideB, time) || moves(sideB, sideA, time)) continue;
+            }
+            relax(next, MoveCost(d));
+        }
+    }
+    return -1;
+}
+
+// 㻥ͬյ㻥ͬոķ֮һ
+std::vector<AgentTask> MakeAgentTasks(const GridMap& map, const std::vector<int>& freeCells, std::mt19937& random) {
+    const int agentCount = std::min(AGENT_CHECK_MAX_AGENTS, static_cast<int>(freeCells.size()) / 4);
+    std::vector<int> starts(freeCells), goals(freeCells);
+    std::shuffle(starts.begin(), starts.end(), random);
+    std::shuffle(goals.begin(), goals.end(), random);
+    std::vector<AgentTask> tasks(std::max(agentCount, 0));
+    for (size_t i = 0; i < tasks.size(); i++) {
+        tasks[i] = { starts[i] % map.width, starts[i] / map.width, goals[i] % map.width, goals[i] / map.width };
+    }
+    return tasks;
+}
+
+MultiAgentOptions MakeAgentOptions(const GridMap& map, const std::vector<AgentTask>& tasks, bool fieldHeuristic) {
+    MultiAgentOptions options;
+    options.horizon = 2 * (map.width + map.height) + static_cast<int>(tasks.size());
+    options.fieldHeuristic = fieldHeuristic;
+    // ȽŴۣչ
+    options.maxExpansions = SIZE_MAX;
+    return options;
+}
+
+size_t RunAgentPlans(const GridMap& map, const std::vector<AgentTask>& tasks, bool fieldHeuristic) {
+    std::vector<AgentPlan> plans;
+    PlanAgents(map, tasks, MakeAgentOptions(map, tasks, fieldHeuristic), plans);
+    size_t expanded = 0;
+    for (size_t i = 0; i < plans.size(); i++) expanded += plans[i].expanded;
+    return expanded;
+}
+
+// ȼ滮ÿ·Ϸȹ滮޳ͻ滮ʧܵͣ㣬飩
+// 밴ͬ˳ܿȹ滮·ͬչΪ1ʱյ㲻ͬ嶼ͣ㣬ֵ
+void CheckAgentPlans(std::ostream& log, const GridMap& map, const std::vector<AgentTask>& tasks, bool fieldHeuristic,
+    EngineStats& stats, int& reported, int maxReportedFailures) {
+    const int agentCount = static_cast<int>(tasks.size());
+    if (agentCount < 2) return;
+    std::vector<int> starts(agentCount), goals(agentCount);
+    for (int i = 0; i < agentCount; i++) {
+        starts[i] = map.Index(tasks[i].startX, tasks[i].startY);
+        goals[i] = map.Index(tasks[i].goalX, tasks[i].goalY);
+    }
+
+    const MultiAgentOptions options = MakeAgentOptions(map, tasks, fieldHeuristic);
+    std::vector<AgentPlan> plans;
+    PlanAgents(map, tasks, options, plans);
+
+    int failures = 0;
+    std::vector<std::vector<int> > earlier;
+    for (int i = 0; i < agentCount; i++) {
+        const AgentPlan& plan = plans[i];
+        stats.queries++;
+
+        std::string problem;
+        const int expected = TimeExpandedCost(map, earlier, starts[i], goals[i], options.search, options.horizon);
+        if (plan.found != (expected >= 0)) {
+            problem = expected >= 0 ? "missed an existing plan" : "found a plan where none exists";
+        }
+        else if (plan.found && CheckAgentPath(map, plan.path, starts[i], goals[i], options.search) != plan.cost) {
+            problem = "invalid path or path cost does not match reported cost";
+        }
+        else if (plan.found && plan.cost != expected) {
+            std::ostringstream text;
+            text << "cost " << plan.cost << " != time-expanded search " << expected;
+            problem = text.str();
+        }
+        else if (plan.path.empty() || plan.path.front() != starts[i]) {
+            problem = "failed agent does not stay at its start";
+        }
+        else {
+            for (int j = 0; plan.found && j < i && problem.empty(); j++) {
+                const int span = static_cast<int>(std::max(plan.path.size(), plans[j].path.size()));
+                for (int t = 0; t < span; t++) {
+                    if (AgentsCollide(map, plan.path, plans[j].path, t)) {
+                        std::ostringstream text;
+                        text << "collides with agent " << j << " at t=" << t;
+                        problem = text.str();
+                        break;
+                    }
+                }
+            }
+        }
+        earlier.push_back(plan.path);
+
+        if (!problem.empty()) {
+            failures++;
+            if (reported++ < maxReportedFailures) {
+                log << "FAIL plan_agents: " << map.width << "x" << map.height << " agent " << i << " ("
+                    << tasks[i].startX << "," << tasks[i].startY << ") -> (" << tasks[i].goalX << "," << tasks[i].goalY
+                    << "): " << problem << "\n";
+            }
+        }
+    }
+
+    MultiAgentOptions capped = options;
+    capped.maxExpansions = 1;
+    const size_t solved = PlanAgents(map, tasks, capped, plans);
+    size_t trivial = 0;
+    bool capHeld = true;
+    for (int i = 0; i < agentCount; i++) {
+        if (starts[i] == goals[i] && plans[i].found) {
+            trivial++;
+            continue;
+        }
+        if (plans[i].found || plans[i].path.size() != 1 || plans[i].path[0] != starts[i] ||
+            (plans[i].gaveUp && plans[i].expanded != 1)) {
+            capHeld = false;
+        }
+    }
+    stats.queries++;
+    if (!capHeld || solved != trivial) {
+        failures++;
+        if (reported++ < maxReportedFailures) {
+            log << "FAIL plan_agents: " << map.width << "x" << map.height << " expansion cap 1 not respected\n";
+        }
+    }
+    stats.failures += failures;
+}
+
+const int EDIT_CHECK_TRANSACTIONS = 16;
+const int EDIT_CHECK_QUERIES = 3;
+// 㹻Слᶪļ¼־
+const size_t EDIT_CHECK_SMALL_JOURNAL = 96;
+
+// ༭־Ķ񣨺ͬһظ޸ģ־¼籣״̬״̬
+// һֺ¼ӦضӦõļ¼GetEntryطӦõǰǽڣ
+// ÿһ֮µԾ½ȫͬµľηֽĲѯDijkstraͬ
+// ־ֱȡĬֵɻصԭʼͼСֵ
+void CheckWallEdits(std::ostream& log, const GridMap& original, std::mt19937& random,
+    EngineStats& stats, int& reported, int maxReportedFailures) {
+
+    if (!JumpTable::Supports(original)) return;
+    for (size_t capacity : { static_cast<size_t>(64u << 20), EDIT_CHECK_SMALL_JOURNAL }) {
+        GridMap map = original;
+        JumpTable table;
+        RectangleGraph graph;
+        table.Build(map);
+        graph.Build(map);
+        EditJournal journal(capacity);
+        std::vector<std::vector<unsigned char> > states(1, map.walls);   // states[k]Ϊ¼kǽ
+        std::vector<int> oracle;
+        SearchWorkspace workspace;
+
+        auto fail = [&](const std::string& step, const std::string& problem) {
+            stats.failures++;
+            if (reported++ < maxReportedFailures) {
+                log << "FAIL wall_edits: " << map.width << "x" << map.height << " journal " << capacity << " bytes, "
+                    << step << ": " << problem << "\n";
+            }
+        };
+        auto apply = [&](const EditTransaction& edit, const std::string& step) {
+            std::vector<int> changed;
+            for (const CellDelta& delta : edit.Deltas()) {
+                if (map.walls[delta.cell] != delta.before) fail(step, "delta does not start from the current wall");
+                map.walls[delta.cell] = delta.after;
+                changed.push_back(delta.cell);
+            }
+            table.SetWalls(map, changed);
+            graph.SetWalls(map, changed);
+
+            stats.queries++;
+            JumpTable rebuilt;
+            rebuilt.Build(map);
+            if (!(rebuilt == table)) fail(step, "incremental jump table differs from a rebuild");
+
+            std::vector<int> freeCells;
+            for (int i = 0; i < map.CellCount(); i++) {
+                if (!map.walls[i]) freeCells.push_back(i);
+            }
+            for (int q = 0; q < EDIT_CHECK_QUERIES && !freeCells.empty(); q++) {
+                const int start = freeCells[random() % freeCells.size()];
+                const int goal = freeCells[random() % freeCells.size()];
+                OracleField(map, std::vector<int>(1, start), SearchOptions(), false, oracle);
+                SearchResult result;
+                graph.FindPath(map, start % map.width, start / map.width, goal % map.width, goal / map.width, workspace, result);
+                const int expected = oracle[goal] == DISTANCE_UNREACHABLE ? -1 : oracle[goal];
+                const int actual = !result.found ? -1 : CheckPath(map, result.path, start, goal, SearchOptions());
+                if (actual != expected || (result.found && result.cost != actual)) {
+                    std::ostringstream text;
+                    text << "rsr (" << start % map.width << "," << start / map.width << ") -> (" << goal % map.width << ","
+                         << goal / map.width << ") cost " << (result.found ? result.cost : -1) << " != reference " << expected;
+                    fail(step, text.str());
+                }
+            }
+        };
+        auto expectWalls = [&](const std::vector<unsigned char>& walls, const std::string& step) {
+            if (map.walls != walls) fail(step, "walls differ from the recorded state");
+        };
+
+        // ÿ޸112ѡĸӿظNormalizeϲܱ
+        for (int t = 0; t < EDIT_CHECK_TRANSACTIONS; t++) {
+            EditTransaction edit(map.width);
+            std::vector<unsigned char> walls = map.walls;
+            std::vector<int> picked(1 + random() % 12);
+            for (size_t i = 0; i < picked.size(); i++) {
+                picked[i] = i > 0 && random() % 4 == 0 ? picked[random() % i] : static_cast<int>(random() % map.CellCount());
+                const int cell = picked[i];
+                edit.Set(cell, walls[cell], !walls[cell]);
+                walls[cell] = !walls[cell];
+            }
+            edit.Normalize();
+            apply(edit, "apply");
+            expectWalls(walls, "apply");
+            // 񲻽־
+            journal.Record(edit);
+            if (!edit.Empty()) states.push_back(walls);
+        }
+        if (capacity == EDIT_CHECK_SMALL_JOURNAL && journal.Bytes() > capacity && journal.AppliedCount() > 1) {
+            fail("record", "journal exceeds its capacity");
+        }
+
+        // طţ籣¼֮ǰ״̬Ӧ
+        const size_t applied = journal.AppliedCount();
+        if (applied < 2 || applied > states.size() - 1) {
+            fail("record", "unexpected number of applied entries");
+            continue;
+        }
+        std::vector<unsigned char> replay = states[states.size() - 1 - applied];
+        for (size_t i = 0; i < applied; i++) {
+            EditTransaction edit;
+            journal.GetEntry(i, edit);
+            for (const CellDelta& delta : edit.Deltas()) replay[delta.cell] = delta.after;
+        }
+        if (replay != states.back()) fail("replay", "replayed entries do not give the final walls");
+
+        EditTransaction edit;
+        size_t undone = 0;
+        while (journal.Undo(edit)) {
+            apply(edit, "undo");
+            undone++;
+        }
+        if (undone != applied) fail("undo", "undo count differs from the applied entries");
+        expectWalls(states[states.size() - 1 - undone], "undo");
+        if (capacity != EDIT_CHECK_SMALL_JOURNAL) expectWalls(original.walls, "undo to original");
+
+        size_t redone = 0;
+        while (journal.Redo(edit)) {
+            apply(edit, "redo");
+            redone++;
+        }
+        if (redone != undone) fail("redo", "redo count differs from the undone entries");
+        expectWalls(states.back(), "redo");
+
+        // ¼֮ǰ
+        const std::vector<unsigned char> beforeBranch = states[states.size() - 3];
+        journal.Undo(edit);
+        apply(edit, "undo before branch");
+        journal.Undo(edit);
+        apply(edit, "undo before branch");
+        expectWalls(beforeBranch, "undo before branch");
+        EditTransaction branch(map.width);
+        const int cell = random() % map.CellCount();
+        branch.Set(cell, map.walls[cell], !map.walls[cell]);
+        apply(branch, "branch");
+        journal.Record(branch);
+        const std::vector<unsigned char> afterBranch = map.walls;
+        if (journal.CanRedo() || journal.Redo(edit)) fail("branch", "redo entries survive a new record");
+        if (!journal.Undo(edit)) {
+            fail("branch", "new record cannot be undone");
+            continue;
+        }
+        apply(edit, "undo branch");
+        expectWalls(beforeBranch, "undo branch");
+        if (!journal.Redo(edit)) {
+            fail("branch", "new record cannot be redone");
+            continue;
+        }
+        apply(edit, "redo branch");
+        expectWalls(afterBranch, "redo branch");
+    }
+}
+
+const int PERSISTENCE_CHECK_QUERIES = 4;
+
+// 𻵵ݣض̻תһλloadӦʧܣԭӦɹûʱΪ
+std::string CheckCorruption(const std::string& payload, std::mt19937& random,
+    const std::function<bool(const std::string&)>& load) {
+    if (!load(payload)) return "saved data does not load";
+    if (load(payload.substr(0, random() % payload.size()))) return "truncated data loads";
+    std::string flipped = payload;
+    flipped[random() % flipped.size()] ^= static_cast<char>(1 << (random() % 8));
+    if (load(flipped)) return "bit-flipped data loads";
+    return std::string();
+}
+
+bool SameResult(const SearchResult& a, const SearchResult& b) {
+    return a.found == b.found && (!a.found || (a.cost == b.cost && a.path == b.path));
+}
+
+// ־ûԤͬһѯԭȫͬĴ𰸣𻵵ݱܾ
+// ·ݿ⾭scratchFileڴӳ
+void CheckPersistence(std::ostream& log, const GridMap& map, const std::vector<int>& freeCells, std::mt19937& random,
+    const std::string& scratchFile, EngineStats& stats, int& reported, int maxReportedFailures) {
+
+    auto report = [&](const char* kind, const std::string& problem) {
+        stats.queries++;
+        if (problem.empty()) return;
+        stats.failures++;
+        if (reported++ < maxReportedFailures) {
+            log << "FAIL persistence: " << map.width << "x" << map.height << " " << kind << ": " << problem << "\n";
+        }
+    };
+    std::vector<int> queries(2 * PERSISTENCE_CHECK_QUERIES);
+    for (size_t i = 0; i < queries.size(); i++) queries[i] = freeCells[random() % freeCells.size()];
+    // ÿѯȽṹĴ
+    auto compare = [&](const std::function<void(int, int, int, int, SearchResult&, SearchResult&)>& query) {
+        for (size_t q = 0; q < queries.size(); q += 2) {
+            SearchResult original, loaded;
+            query(queries[q] % map.width, queries[q] / map.width, queries[q + 1] % map.width, queries[q + 1] / map.width,
+                original, loaded);
+            if (!SameResult(original, loaded)) return std::string("loaded structure answers differently");
+        }
+        return std::string();
+    };
+
+    SubgoalGraph subgoals, loadedSubgoals;
+    subgoals.Build(map);
+    const std::string subgoalPayload = subgoals.Serialize();
+    std::string problem = CheckCorruption(subgoalPayload, random, [&](const std::string& payload) {
+        SubgoalGraph graph;
+        return graph.Deserialize(payload, map);
+    });
+    if (problem.empty()) {
+        loadedSubgoals.Deserialize(subgoalPayload, map);
+        SubgoalQueryWorkspace workspace;
+        problem = compare([&](int startX, int startY, int goalX, int goalY, SearchResult& original, SearchResult& loaded) {
+            subgoals.FindPath(map, startX, startY, goalX, goalY, workspace, original);
+            loadedSubgoals.FindPath(map, startX, startY, goalX, goalY, workspace, loaded);
+        });
+    }
+    report("subgoal graph", problem);
+
+    if (JumpTable::Supports(map)) {
+        JumpTable table, loadedTable;
+        table.Build(map);
+        const std::string tablePayload = table.Serialize(map);
+        problem = CheckCorruption(tablePayload, random, [&](const std::string& payload) {
+            JumpTable other;
+            return other.Deserialize(payload, map);
+        });
+        if (problem.empty()) {
+            loadedTable.Deserialize(tablePayload, map);
+            if (!(loadedTable == table)) problem = "loaded jump table differs";
+        }
+        if (problem.empty()) {
+            SearchWorkspace workspace;
+            problem = compare([&](int startX, int startY, int goalX, int goalY, SearchResult& original, SearchResult& loaded) {
+                table.FindPath(map, startX, startY, goalX, goalY, workspace, original);
+                loadedTable.FindPath(map, startX, startY, goalX, goalY, workspace, loaded);
+            });
+        }
+        report("jump table", problem);
+    }
+
+    RectangleGraph rectangles, loadedRectangles;
+    rectangles.Build(map);
+    const std::string rectanglePayload = rectangles.Serialize(map);
+    problem = CheckCorruption(rectanglePayload, random, [&](const std::string& payload) {
+        RectangleGraph graph;
+        return graph.Deserialize(payload, map);
+    });
+    if (problem.empty()) {
+        SearchWorkspace workspace;
+        loadedRectangles.Deserialize(rectanglePayload, map);
+        problem = compare([&](int startX, int startY, int goalX, int goalY, SearchResult& original, SearchResult& loaded) {
+            rectangles.FindPath(map, startX, startY, goalX, goalY, workspace, original);
+            loadedRectangles.FindPath(map, startX, startY, goalX, goalY, workspace, loaded);
+        });
+    }
+    report("rectangles", problem);
+
+    if (map.CellCount() <= PATH_DB_MAX_CELLS) {
+        PathDatabase database, loadedDatabase;
+        database.Build(map);
+        std::string bytes;
+        if (database.Save(scratchFile)) {
+            std::ifstream input(scratchFile.c_str(), std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        }
+        if (bytes.empty()) {
+            problem = "cannot save to " + scratchFile;
+        }
+        else {
+            problem = CheckCorruption(bytes, random, [&](const std::string& content) {
+                std::ofstream output(scratchFile.c_str(), std::ios::binary | std::ios::trunc);
+                output.write(content.data(), content.size());
+                output.close();
+                PathDatabase other;
+                return other.Open(scratchFile, map);
+            });
+        }
+        if (problem.empty()) {
+            database.Save(scratchFile);
+            if (!loadedDatabase.Open(scratchFile, map)) problem = "saved database does not open";
+        }
+        if (problem.empty()) {
+            problem = compare([&](int startX, int startY, int goalX, int goalY, SearchResult& original, SearchResult& loaded) {
+                database.FindPath(startX, startY, goalX, goalY, original);
+                loadedDatabase.FindPath(startX, startY, goalX, goalY, loaded);
+            });
+        }
+        report("path database", problem);
+    }
+}
+
+const int PROFILE_CHECK_THREADS = 2;
+const int PROFILE_CHECK_QUERIES = 16;
+
+// չȶͳƣͬһѯָ̡߳Լļϲÿչ֮͵ڸѯչ֮ͣ
+// CSVƵغϲͬJPS+ηֽĿͼͳ
+void CheckProfiler(std::ostream& log, const GridMap& map, const std::vector<int>& freeCells, std::mt19937& random,
+    const std::string& scratchFile, EngineStats& stats, int& reported, int maxReportedFailures) {
+
+    PaddedGrid grid;
+    grid.Build(map);
+    JumpTable table;
+    if (JumpTable::Supports(map)) table.Build(map);
+    RectangleGraph rectangles;
+    rectangles.Build(map);
+    SubgoalGraph subgoals;
+    subgoals.Build(map);
+    std::vector<int> queries(2 * PROFILE_CHECK_QUERIES);
+    for (size_t i = 0; i < queries.size(); i++) queries[i] = freeCells[random() % freeCells.size()];
+
+    SearchProfiler profiler(map.width, map.height);
+    std::vector<uint64_t> reportedExpanded(PROFILE_CHECK_THREADS, 0);
+    auto worker = [&](int index) {
+        ProfileCounters* counters = profiler.AddThread();
+        SearchWorkspace workspace;
+        SubgoalQueryWorkspace subgoalWorkspace;
+        workspace.profile = counters;
+        subgoalWorkspace.search.profile = counters;
+        for (size_t q = 2 * index; q < queries.size(); q += 2 * PROFILE_CHECK_THREADS) {
+            const int startX = queries[q] % map.width, startY = queries[q] / map.width;
+            const int goalX = queries[q + 1] % map.width, goalY = queries[q + 1] / map.width;
+            SearchResult result;
+            RunGridSearch(grid, startX, startY, goalX, goalY, SearchOptions(), workspace, result);
+            reportedExpanded[index] += result.expanded;
+            if (table.IsBuiltFor(map)) {
+                table.FindPath(map, startX, startY, goalX, goalY, workspace, result);
+                reportedExpanded[index] += result.expanded;
+            }
+            rectangles.FindPath(map, startX, startY, goalX, goalY, workspace, result);
+            reportedExpanded[index] += result.expanded;
+            subgoals.FindPath(map, startX, startY, goalX, goalY, subgoalWorkspace, result);
+            reportedExpanded[index] += result.expanded;
+            counters->queries++;
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < PROFILE_CHECK_THREADS; t++) threads.emplace_back(worker, t);
+    for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+
+    ProfileCounters total;
+    profiler.Merge(total);
+    uint64_t expected = 0, counted = 0;
+    for (int t = 0; t < PROFILE_CHECK_THREADS; t++) expected += reportedExpanded[t];
+    for (size_t i = 0; i < total.expanded.size(); i++) counted += total.expanded[i];
+
+    std::string problem;
+    if (counted != expected || total.queries != static_cast<uint64_t>(PROFILE_CHECK_QUERIES)) {
+        std::ostringstream text;
+        text << "merged expansions " << counted << " != reported " << expected;
+        problem = text.str();
+    }
+    else if (!WriteProfileCsv(scratchFile, total, PROFILE_EXPANDED)) {
+        problem = "cannot write csv to " + scratchFile;
+    }
+    else {
+        std::ifstream input(scratchFile.c_str());
+        std::vector<uint32_t> values;
+        std::string line;
+        int rows = 0;
+        while (std::getline(input, line)) {
+            rows++;
+            std::istringstream row(line);
+            std::string value;
+            while (std::getline(row, value, ',')) values.push_back(static_cast<uint32_t>(std::stoul(value)));
+        }
+        if (rows != map.height || values != total.expanded) problem = "csv export does not read back";
+    }
+    if (problem.empty()) {
+        if (!WriteProfileBinary(scratchFile, total)) {
+            problem = "cannot write binary to " + scratchFile;
+        }
+        else {
+            std::ifstream input(scratchFile.c_str(), std::ios::binary);
+            char tag[4] = { 0 };
+            uint32_t header[4] = { 0 };
+            std::vector<uint32_t> expanded(total.expanded.size()), pushed(total.pushed.size());
+            input.read(tag, sizeof(tag));
+            input.read(reinterpret_cast<char*>(header), sizeof(header));
+            input.read(reinterpret_cast<char*>(expanded.data()), expanded.size() * sizeof(uint32_t));
+            input.read(reinterpret_cast<char*>(pushed.data()), pushed.size() * sizeof(uint32_t));
+            const bool complete = static_cast<bool>(input) && input.peek() == std::char_traits<char>::eof();
+            if (!complete || std::string(tag, 4) != "HEAT" || static_cast<int>(header[0]) != map.width ||
+                static_cast<int>(header[1]) != map.height || (header[2] | (static_cast<uint64_t>(header[3]) << 32)) != total.queries ||
+                expanded != total.expanded || pushed != total.pushed) {
+                problem = "binary export does not read back";
+            }
+        }
+    }
+
+    stats.queries++;
+    if (!problem.empty()) {
+        stats.failures++;
+        if (reported++ < maxReportedFailures) {
+            log << "FAIL profiler: " << map.width << "x" << map.height << ": " << problem << "\n";
+        }
+    }
+}
+
+std::map<std::string, double> LoadBaseline(const std::string& file) {
+    std::map<std::string, double> baseline;
+    std::ifstream input(file.c_str());
+    std::string name;
+    double value;
+    while (input >> name >> value) {
+        baseline[name] = value;
+    }
+    return baseline;
+}
+
+} // namespace
+
+int RunVerifyHarness(std::ostream& log, const VerifyOptions& options) {
+    const int sizes[][2] = { {16, 16}, {40, 30}, {64, 64}, {128, 96} };
+    const int densities[] = { 0, 10, 25, 40 };
+    const int maxReportedFailures = 20;
+
+    std::mt19937 random(options.seed);
+    std::vector<std::unique_ptr<VerifyEngine> > engines = CreateEngines();
+    std::vector<EngineStats> stats(engines.size());
+    EngineStats fieldStats;
+    EngineStats agentStats;
+    EngineStats editStats;
+    EngineStats persistenceStats;
+    EngineStats profilerStats;
+    // ־ûȶȵдʱļڻ׼ļԱ
+    const std::string scratchFile = options.baselineFile + ".tmp";
+    std::vector<int> oracle;
+    int reported = 0;
+    int totalQueries = 0;
+
+    for (const auto& size : sizes) {
+        for (int density : densities) {
+            for (int m = 0; m < options.mapsPerConfig; m++) {
+                GridMap map = GenerateMap(random, size[0], size[1], density);
+
+                std::vector<int> freeCells;
+                for (int i = 0; i < map.CellCount(); i++) {
+                    if (!map.walls[i]) freeCells.push_back(i);
+                }
+                if (freeCells.size() < 2) continue;
+
+                for (size_t e = 0; e < engines.size(); e++) {
+                    if (engines[e]->Supports(map)) engines[e]->Prepare(map);
+                }
+
+                for (int q = 0; q < options.queriesPerMap; q++) {
+                    int start = freeCells[random() % freeCells.size()];
+                    int goal = freeCells[random() % freeCells.size()];
+                    int startX = start % map.width, startY = start / map.width;
+                    int goalX = goal % map.width, goalY = goal / map.width;
+
+                    SearchResult expected;
+                    RunReferenceSearch(map, startX, startY, goalX, goalY, expected);
+                    totalQueries++;
+                    // οֻ֧ĬƶDijkstraΪ׼㣨-2ʾδ㣩
+                    int ruleCost[2][2] = { { -2, -2 }, { -2, -2 } };
+
+                    for (size_t e = 0; e < engines.size(); e++) {
+                        if (!engines[e]->Supports(map)) continue;
+                        const SearchOptions rules = engines[e]->Options();
+                        int expectedCost = expected.found ? expected.cost : -1;
+                        if (rules.connectivity != 8 || rules.cornerRule != CORNER_BLOCK_BOTH) {
+                            int& cached = ruleCost[rules.connectivity == 4][rules.cornerRule == CORNER_BLOCK_ANY];
+                            if (cached == -2) {
+                                OracleField(map, std::vector<int>(1, start), rules, false, oracle);
+                                cached = oracle[goal];
+                            }
+                            expectedCost = cached;
+                        }
+
+                        // ȼһβѯĽֹʱжΪ׼
+                        SearchResult actual;
+                        engines[e]->Query(startX, startY, goalX, goalY, actual);
+                        const double bound = engines[e]->CostBound();
+                        std::string problem;
+                        if (actual.found != (expectedCost >= 0) && !(expectedCost >= 0 && engines[e]->MayGiveUp())) {
+                            problem = expectedCost >= 0 ? "missed an existing path" : "found a path where none exists";
+                        }
+                        else if (actual.found && (actual.cost < expectedCost || actual.cost > expectedCost * bound + 1e-6)) {
+                            std::ostringstream text;
+                            text << "cost " << actual.cost << " != reference " << expectedCost;
+                            if (bound > 1.0) text << " (bound " << bound << ")";
+                            problem = text.str();
+                        }
+                        else if (actual.found && CheckPath(map, actual.path, start, goal, rules) != actual.cost) {
+                            problem = "invalid path or path cost does not match reported cost";
+                        }
+                        else if (actual.found) {
+                            problem = CheckPathEncoding(map, actual.path);
+                        }
+
+                        stats[e].queries++;
+
+                        if (!problem.empty()) {
+                            stats[e].failures++;
+                            if (reported++ < maxReportedFailures) {
+                                log << "FAIL " << engines[e]->Name() << ": " << map.width << "x" << map.height
+                                    << " walls " << density << "% map " << m << " (" << startX << "," << startY
+                                    << ") -> (" << goalX << "," << goalY << "): " << problem << "\n";
+                            }
+                        }
+                    }
+                }
+
+                if (map.CellCount() <= ORACLE_MAX_CELLS) {
+                    CheckDistanceFields(log, map, PickSources(freeCells, random), fieldStats, reported, maxReportedFailures);
+                    CheckAgentPlans(log, map, MakeAgentTasks(map, freeCells, random), m % 2 == 1, agentStats, reported,
+                        maxReportedFailures);
+                    CheckWallEdits(log, map, random, editStats, reported, maxReportedFailures);
+                    CheckPersistence(log, map, freeCells, random, scratchFile, persistenceStats, reported, maxReportedFailures);
+                    CheckProfiler(log, map, freeCells, random, scratchFile, profilerStats, reported, maxReportedFailures);
+                }
+            }
+        }
+    }
+
+    std::remove(scratchFile.c_str());
+
+    // ù̶Ĺʱ--seed--maps޹أÿݹظtimingRoundsȡһΣÿֳߴܶһŵͼѯ볡Դ
+    // ɹ̶ɣ滮ÿŵͼϷֱ벻þ볡ֵ滮һ
+    std::mt19937 timingRandom(TIMING_SEED);
+    for (const auto& size : sizes) {
+        for (int density : densities) {
+            GridMap map = GenerateMap(timingRandom, size[0], size[1], density);
+            std::vector<int> freeCells;
+            for (int i = 0; i < map.CellCount(); i++) {
+                if (!map.walls[i]) freeCells.push_back(i);
+            }
+            if (freeCells.size() < 2) continue;
+
+            std::vector<int> queries(2 * TIMING_QUERIES_PER_MAP);
+            for (size_t i = 0; i < queries.size(); i++) queries[i] = freeCells[timingRandom() % freeCells.size()];
+
+            for (size_t e = 0; e < engines.size(); e++) {
+                if (!engines[e]->Supports(map)) continue;
+                engines[e]->Prepare(map);
+                TimeBestOf(options.timingRounds, stats[e], [&]() {
+                    size_t expanded = 0;
+                    for (size_t q = 0; q < queries.size(); q += 2) {
+                        SearchResult timed;
+                        engines[e]->Query(queries[q] % map.width, queries[q] / map.width,
+                            queries[q + 1] % map.width, queries[q + 1] / map.width, timed);
+                        expanded += timed.expanded;
+                    }
+                    return expanded;
+                });
+            }
+
+            if (map.CellCount() <= ORACLE_MAX_CELLS) {
+                const std::vector<int> sources = PickSources(freeCells, timingRandom);
+                std::vector<int> distances;
+                TimeBestOf(options.timingRounds, fieldStats, [&]() { return RunDistanceFields(map, sources, distances); });
+                const std::vector<AgentTask> tasks = MakeAgentTasks(map, freeCells, timingRandom);
+                TimeBestOf(options.timingRounds, agentStats, [&]() { return RunAgentPlans(map, tasks, false); });
+                TimeBestOf(options.timingRounds, agentStats, [&]() { return RunAgentPlans(map, tasks, true); });
+            }
+        }
+    }
+
+    // ͼϽǡյ½ǵĸ˷֮һΧڣߵĴӦͬ
+    EngineStats largeKernelStats, largeParallelStats;
+    {
+        GridMap large = GenerateMap(timingRandom, LARGE_MAP_SIDE, LARGE_MAP_SIDE, LARGE_MAP_WALL_PERCENT);
+        std::vector<int> queries;
+        while (static_cast<int>(queries.size()) < 2 * LARGE_MAP_QUERIES) {
+            const int corner = LARGE_MAP_SIDE / 8;
+            const int offset = queries.size() % 2 == 0 ? 0 : LARGE_MAP_SIDE - corner;
+            const int cell = large.Index(offset + timingRandom() % corner, offset + timingRandom() % corner);
+            if (!large.walls[cell]) queries.push_back(cell);
+        }
+        KernelEngine kernel("kernel", SearchOptions());
+        ParallelEngine parallel;
+        const std::pair<VerifyEngine*, EngineStats*> timed[] = {
+            std::make_pair(static_cast<VerifyEngine*>(&kernel), &largeKernelStats),
+            std::make_pair(static_cast<VerifyEngine*>(&parallel), &largeParallelStats) };
+        std::vector<int> costs[2];
+        for (int e = 0; e < 2; e++) {
+            timed[e].first->Prepare(large);
+            TimeBestOf(options.timingRounds, *timed[e].second, [&]() {
+                size_t expanded = 0;
+                costs[e].clear();
+                for (size_t q = 0; q < queries.size(); q += 2) {
+                    SearchResult result;
+                    timed[e].first->Query(queries[q] % large.width, queries[q] / large.width,
+                        queries[q + 1] % large.width, queries[q + 1] / large.width, result);
+                    costs[e].push_back(result.found ? result.cost : -1);
+                    expanded += result.expanded;
+                }
+                return expanded;
+            });
+            timed[e].second->queries = queries.size() / 2;
+        }
+        if (costs[0] != costs[1]) {
+            largeParallelStats.failures++;
+            log << "FAIL parallel_large: cost differs from the single-thread kernel on a " << LARGE_MAP_SIDE << "x"
+                << LARGE_MAP_SIDE << " map\n";
+        }
+    }
+
+    // ׼Ƚ
+    // ׼ļȱʧȱĳʱжʧܣֻʽҪʱ¼¼ɾ׼龲Ĭͨ
+    std::map<std::string, double> baseline = LoadBaseline(options.baselineFile);
+    const bool writeBaseline = options.updateBaseline;
+    // 롢༭־ûȶͳƼ鲻ʱֻͳʧ
+    int failures = CheckEncodingEdgeCases(log) + editStats.failures + persistenceStats.failures + profilerStats.failures;
+    int regressions = 0;
+    if (!writeBaseline && baseline.empty()) {
+        log << "cannot read baseline " << options.baselineFile << " (run with --update-baseline to record one)\n";
+        regressions++;
+    }
+
+    // ͼ볡滮һ𱨸ͱȽϻ׼
+    std::vector<std::pair<std::string, const EngineStats*> > rows;
+    for (size_t e = 0; e < engines.size(); e++) rows.push_back(std::make_pair(std::string(engines[e]->Name()), &stats[e]));
+    rows.push_back(std::make_pair(std::string("distance_fields"), &fieldStats));
+    rows.push_back(std::make_pair(std::string("plan_agents"), &agentStats));
+    rows.push_back(std::make_pair(std::string("kernel_large"), &largeKernelStats));
+    rows.push_back(std::make_pair(std::string("parallel_large"), &largeParallelStats));
+
+    log << totalQueries << " queries, seed " << options.seed << "\n";
+    log << "wall_edits: " << editStats.queries << " steps, " << editStats.failures << " failures\n";
+    log << "persistence: " << persistenceStats.queries << " round trips, " << persistenceStats.failures << " failures\n";
+    log << "profiler: " << profilerStats.queries << " workloads, " << profilerStats.failures << " failures\n";
+    for (size_t r = 0; r < rows.size(); r++) {
+        const std::string& name = rows[r].first;
+        const EngineStats& row = *rows[r].second;
+        double rate = row.seconds > 0.0 ? row.expanded / row.seconds : 0.0;
+        failures += row.failures;
+
+        log << name << ": " << row.queries << " queries, " << row.failures << " failures, "
+            << static_cast<long long>(rate) << " expansions/s";
+
+        auto found = baseline.find(name);
+        if (!writeBaseline && found != baseline.end() && found->second > 0.0) {
+            double change = rate / found->second - 1.0;
+            log << " (" << (change >= 0 ? "+" : "") << static_cast<int>(change * 100) << "% vs baseline)";
+            if (change < -options.regressionThreshold) {
+                log << " REGRESSION";
+                regressions++;
+            }
+        }
+        else if (!writeBaseline && !baseline.empty()) {
+            log << " NO BASELINE";
+            regressions++;
+        }
+        log << "\n";
+    }
+
+    // A*չĽڵȵ̶߳࣬Ƚϵͬһѯĺʱ˻϶ֻ߳ǽִ
+    if (largeKernelStats.seconds > 0.0 && largeParallelStats.seconds > 0.0) {
+        log << "parallel_large vs kernel_large: " << std::fixed << std::setprecision(2)
+            << largeKernelStats.seconds / largeParallelStats.seconds << "x speed (" << LARGE_MAP_SIDE << "x" << LARGE_MAP_SIDE
+            << ", 4 threads, " << std::thread::hardware_concurrency() << " hardware threads)\n";
+        log.unsetf(std::ios::floatfield);
+    }
+
+    if (writeBaseline) {
+        std::ofstream output(options.baselineFile.c_str());
+        for (size_t r = 0; r < rows.size(); r++) {
+            const EngineStats& row = *rows[r].second;
+            double rate = row.seconds > 0.0 ? row.expanded / row.seconds : 0.0;
+            output << rows[r].first << " " << static_cast<long long>(rate) << "\n";
+        }
+        log << "baseline written to " << options.baselineFile << "\n";
+    }
+
+    bool passed = failures == 0 && regressions == 0;
+    log << (passed ? "PASSED" : "FAILED") << "\n";
+    return passed ? 0 : 1;
+}
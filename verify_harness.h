@@ -0,0 +1,25 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+
+// ȷܻع飺
+// ɲͬߴ硢ǽܶȺӵͼԲοΪ׼һ
+// ·ϷԣڡǽֱǽǷһ£ƶDijkstraΪ׼
+// ֹʱARA*ֻҪ󲻳ĴŽ磩ͼ볡Ƚϣ
+// 滮ʱ䲽չΪ׼֮ûгͻ
+// ÿչڵ׼ļȽϣ½ֵжʧܡ
+// ʱõĵͼѯɹ̶ɣseedmapsPerConfig޹
+
+struct VerifyOptions {
+    unsigned int seed = 1;                  // 
+    int mapsPerConfig = 5;                  // ÿֳߴܶɵĵͼ
+    int queriesPerMap = 8;                  // ÿŵͼĲѯ
+    int timingRounds = 5;                   // ʱʱÿݹظĴȡһΣ
+    std::string baselineFile = "perf_baseline.txt";
+    double regressionThreshold = 0.25;      // ½
+    bool updateBaseline = false;            // ñνǻ׼ļ׼ļȱʧȱжʧ
+};
+
+// 0ʾȫͨ
+int RunVerifyHarness(std::ostream& log, const VerifyOptions& options);